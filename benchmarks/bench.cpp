@@ -0,0 +1,434 @@
+// Benchmark harness for the quickopt C++ core - runs pso, genetic, anneal and bayesopt_tpe on the test functions in functions.hpp
+// across dimensions and population sizes, and writes one JSON record per run with the optimizer's overhead per iteration (excluding
+// objective time), the number of evaluations until the target was reached, and the peak memory of the run
+//
+// Usage: quickopt_bench [--out FILE] [--optimizers pso,genetic,anneal,tpe] [--functions sphere,...,onemax,string_match]
+//                       [--dims 2,10,30] [--sizes 20,100] [--iterations 200] [--tpe-iterations 100] [--target 1e-2] [--repeats 1] [--seed 0]
+// Each case is seeded from --seed and its optimizer, function, dimension, size and repeat, so a report can be reproduced run for run
+
+#include <quickopt/quickopt.hpp>
+#include "functions.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifndef QUICKOPT_VERSION
+#define QUICKOPT_VERSION "unknown"
+#endif
+
+using namespace quickopt::bench;
+using Clock = std::chrono::steady_clock;
+
+// Settings of the whole benchmark
+struct Settings {
+    std::string out; // Output file - empty for stdout
+    std::vector<std::string> optimizers = {"pso", "genetic", "anneal", "tpe"};
+    std::vector<std::string> functions = {"sphere", "rastrigin", "ackley", "rosenbrock", "griewank", "schwefel", "onemax", "string_match"};
+    std::vector<size_t> dims = {2, 10, 30};
+    std::vector<int> sizes = {20, 100}; // Swarm and population sizes, and the number of acquisition samples of TPE
+    int iterations = 200; // Iterations of pso and generations of genetic - anneal takes iterations * size steps
+    int tpe_iterations = 100; // Iterations of bayesopt_tpe
+    double target = 1e-2; // A run reaches its target once a value is within this of the global minimum of 0
+    int repeats = 1; // Runs of each case
+    long long seed = 0; // Seed every case's seed is derived from
+};
+
+// Wraps a test function, counting its evaluations and timing them, and recording when the target was first reached
+template <typename T>
+struct Probe {
+    double (*f)(const T*, size_t);
+    double target;
+    size_t evaluations = 0;
+    size_t evaluations_to_target = 0; // 0 until the target is reached
+    double best = std::numeric_limits<double>::infinity();
+    Clock::duration objective_time = Clock::duration::zero();
+
+    double operator()(const T* x, size_t n) {
+        Clock::time_point start = Clock::now();
+        double value = f(x, n);
+        objective_time += Clock::now() - start;
+        evaluations++;
+        best = std::min(best, value);
+        if (evaluations_to_target == 0 && value <= target) { // If this is the first value to reach the target...
+            evaluations_to_target = evaluations;
+        }
+        return value;
+    }
+};
+
+// Outcome of a single run, written as a JSON object
+struct Run {
+    std::string optimizer, function, type;
+    size_t dim = 0;
+    int size = 0; // Population size, or 0 if the optimizer has none
+    int iterations = 0;
+    int repeat = 0;
+    long long seed = 0; // Seed of the run's initial guesses and of the optimizer's random number generator
+};
+
+// Split a comma-separated list
+static std::vector<std::string> split_list(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+// Seed of a case - mixes the benchmark seed with the case's identity, so a case keeps its seed whichever other cases run
+// Kept to 53 bits so it is exact as a JSON number
+static long long case_seed(long long seed, const Run& run) {
+    std::string key = run.optimizer + "/" + run.function + "/" + std::to_string(run.dim) + "/" + std::to_string(run.size) + "/" + std::to_string(run.repeat);
+    uint64_t hash = 0xcbf29ce484222325ULL; // FNV-1a hash of the identity
+    for (char c : key) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+    }
+    return static_cast<long long>(quickopt::stream_seed(static_cast<uint64_t>(seed), hash) >> 11);
+}
+
+// Random genome of a test function's parameter type
+static std::vector<double> random_params(size_t dim, double low, double high, std::mt19937& rng) {
+    std::uniform_real_distribution<double> u(low, high);
+    std::vector<double> x(dim);
+    for (double& v : x) {
+        v = u(rng);
+    }
+    return x;
+}
+
+static std::vector<int> random_bits(size_t dim, std::mt19937& rng) {
+    std::vector<int> x(dim);
+    for (int& v : x) {
+        v = static_cast<int>(rng() & 1);
+    }
+    return x;
+}
+
+static const std::string& letters() {
+    static const std::string alphabet = "abcdefghijklmnopqrstuvwxyz";
+    return alphabet;
+}
+
+static std::vector<std::string> random_words(size_t dim, std::mt19937& rng) {
+    std::vector<std::string> x(dim, std::string(match_word().size(), 'a'));
+    for (std::string& word : x) {
+        for (char& c : word) {
+            c = letters()[rng() % letters().size()];
+        }
+    }
+    return x;
+}
+
+// Run one case and return its JSON fields, without the closing brace
+template <typename T>
+static std::string run_case(const Run& run, Probe<T>& probe, const std::function<void()>& optimize) {
+    Clock::time_point start = Clock::now();
+    optimize();
+    double total = std::chrono::duration<double>(Clock::now() - start).count();
+    double objective = std::chrono::duration<double>(probe.objective_time).count();
+    double overhead = std::max(0.0, total - objective); // Time spent in the optimizer itself
+
+    std::ostringstream json;
+    json.precision(9);
+    json << "{\"optimizer\": \"" << run.optimizer << "\", \"function\": \"" << run.function << "\", \"type\": \"" << run.type << "\""
+         << ", \"dim\": " << run.dim << ", \"size\": " << run.size << ", \"iterations\": " << run.iterations << ", \"repeat\": " << run.repeat
+         << ", \"seed\": " << run.seed << ", \"evaluations\": " << probe.evaluations << ", \"evaluations_to_target\": ";
+    if (probe.evaluations_to_target > 0) {
+        json << probe.evaluations_to_target;
+    } else {
+        json << "null";
+    }
+    json << ", \"best_value\": " << probe.best << ", \"total_seconds\": " << total << ", \"objective_seconds\": " << objective
+         << ", \"overhead_per_iteration_us\": " << (run.iterations > 0 ? overhead / run.iterations * 1e6 : 0.0)
+         << ", \"overhead_per_evaluation_us\": " << (probe.evaluations > 0 ? overhead / probe.evaluations * 1e6 : 0.0);
+    return json.str();
+}
+
+// Run a case on a continuous test function
+static std::string run_continuous(const Settings& settings, Run run, const ContinuousFunction& function) {
+    Probe<double> probe{function.f, settings.target};
+    std::vector<double> lower(run.dim, function.low), upper(run.dim, function.high);
+    std::mt19937 rng(static_cast<std::mt19937::result_type>(run.seed));
+    double width = function.high - function.low;
+    std::function<void()> optimize;
+
+    if (run.optimizer == "pso") {
+        optimize = [&] {
+            quickopt::pso([&](const double* x, size_t n) { return -probe(x, n); }, lower, upper, run.iterations, run.size, 0.5, 1.0, 2.0, 0.1 * width, -1, nullptr, nullptr, nullptr, run.seed);
+        };
+    } else if (run.optimizer == "genetic") {
+        quickopt::GeneticOperators<double> operators;
+        operators.crossover_op = quickopt::GeneticOperators<double>::Crossover::blend;
+        operators.crossover_bounded = true;
+        operators.crossover_low = function.low;
+        operators.crossover_high = function.high;
+        operators.mutation_op = quickopt::GeneticOperators<double>::Mutation::gaussian;
+        operators.sigma = 0.05 * width;
+        operators.mutation_bounded = true;
+        operators.mutation_low = function.low;
+        operators.mutation_high = function.high;
+        optimize = [&, operators] {
+            quickopt::genetic([&](const double* genomes, size_t n, size_t dim, double* fitness) {
+                for (size_t i = 0; i < n; ++i) {
+                    fitness[i] = -probe(genomes + i * dim, dim);
+                }
+            }, [&] { return random_params(run.dim, function.low, function.high, rng); }, {}, operators,
+                run.size, std::max(2, run.size / 5), run.size / 10, 0.3, run.iterations, 0, static_cast<quickopt::EvalCache<double>*>(nullptr), nullptr, nullptr, nullptr, run.seed);
+        };
+    } else if (run.optimizer == "anneal") {
+        quickopt::AnnealOperators<double> operators;
+        operators.move = quickopt::AnnealOperators<double>::Neighbor::gaussian;
+        operators.sigma = 0.01 * width;
+        operators.low = function.low;
+        operators.high = function.high;
+        operators.t0 = 1.0;
+        operators.alpha = std::pow(1e-4, 1.0 / run.iterations); // Cool by four orders of magnitude over the run
+        optimize = [&, operators] {
+            quickopt::anneal(probe, random_params(run.dim, function.low, function.high, rng), operators, run.iterations, -1, nullptr, nullptr, nullptr, run.seed);
+        };
+    } else { // TPE
+        optimize = [&] {
+            quickopt::bayesopt_tpe([&](const double* points, size_t n, size_t dim, double* values) {
+                for (size_t p = 0; p < n; ++p) {
+                    values[p] = probe(points + p * dim, dim);
+                }
+            }, lower, upper, run.iterations, 10, run.size, 0, 0.5, 9999, {}, 1, -107.2931, {}, "exact", 1e-3, 1, run.seed);
+        };
+    }
+    return run_case(run, probe, optimize);
+}
+
+// Run a case on a discrete test function - only genetic and anneal take integers and strings
+template <typename T>
+static std::string run_discrete(Run run, Probe<T>& probe, const std::function<std::vector<T>(std::mt19937&)>& generate) {
+    std::mt19937 rng(static_cast<std::mt19937::result_type>(run.seed));
+    std::function<void()> optimize;
+    if (run.optimizer == "genetic") {
+        quickopt::GeneticOperators<T> operators;
+        if constexpr (std::is_integral<T>::value) {
+            operators.mutation_op = quickopt::GeneticOperators<T>::Mutation::bit_flip;
+        } else {
+            operators.mutation_op = quickopt::GeneticOperators<T>::Mutation::char_substitution;
+            operators.alphabet = letters();
+        }
+        optimize = [&, operators] {
+            quickopt::genetic([&](const T* genomes, size_t n, size_t dim, double* fitness) {
+                for (size_t i = 0; i < n; ++i) {
+                    fitness[i] = -probe(genomes + i * dim, dim);
+                }
+            }, [&] { return generate(rng); }, {}, operators, run.size, std::max(2, run.size / 5), run.size / 10, 0.3, run.iterations, 0, static_cast<quickopt::EvalCache<T>*>(nullptr), nullptr, nullptr, nullptr, run.seed);
+        };
+    } else { // Anneal
+        quickopt::AnnealOperators<T> operators;
+        if constexpr (std::is_integral<T>::value) {
+            operators.move = quickopt::AnnealOperators<T>::Neighbor::integer_step;
+            operators.low = 0;
+            operators.high = 1;
+        } else {
+            operators.move = quickopt::AnnealOperators<T>::Neighbor::string_edit;
+            operators.alphabet = letters();
+        }
+        operators.alpha = std::pow(1e-4, 1.0 / run.iterations); // Cool by four orders of magnitude over the run
+        optimize = [&, operators] {
+            quickopt::anneal(probe, generate(rng), operators, run.iterations, -1, nullptr, nullptr, nullptr, run.seed);
+        };
+    }
+    return run_case(run, probe, optimize);
+}
+
+// Run one case in a child process, so its peak memory is its own - returns the complete JSON object
+static std::string run_isolated(const std::function<std::string()>& run) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        throw std::runtime_error("Failed to create a pipe!");
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        throw std::runtime_error("Failed to fork!");
+    }
+    if (pid == 0) { // If this is the child...
+        close(fds[0]);
+        std::string json;
+        try {
+            json = run();
+        } catch (const std::exception& e) {
+            std::cerr << "Run failed: " << e.what() << std::endl;
+            _exit(1);
+        }
+        size_t written = 0;
+        while (written < json.size()) { // Send the record to the parent
+            ssize_t w = write(fds[1], json.data() + written, json.size() - written);
+            if (w <= 0) {
+                _exit(1);
+            }
+            written += static_cast<size_t>(w);
+        }
+        _exit(0);
+    }
+    close(fds[1]);
+    std::string json;
+    char buffer[4096];
+    ssize_t r;
+    while ((r = read(fds[0], buffer, sizeof(buffer))) > 0) { // Collect the child's record
+        json.append(buffer, static_cast<size_t>(r));
+    }
+    close(fds[0]);
+    int status = 0;
+    struct rusage usage;
+    std::memset(&usage, 0, sizeof(usage));
+    if (wait4(pid, &status, 0, &usage) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || json.empty()) {
+        throw std::runtime_error("Benchmark run failed!");
+    }
+    return json + ", \"peak_rss_kb\": " + std::to_string(usage.ru_maxrss) + "}"; // ru_maxrss is in kilobytes on Linux
+}
+
+int main(int argc, char** argv) {
+    Settings settings;
+    for (int i = 1; i < argc; ++i) { // Parse the options
+        std::string option = argv[i];
+        if (option == "--help" || option == "-h") {
+            std::cout << "Usage: quickopt_bench [--out FILE] [--optimizers pso,genetic,anneal,tpe] [--functions LIST] [--dims LIST] [--sizes LIST]\n"
+                         "                      [--iterations N] [--tpe-iterations N] [--target GAP] [--repeats N] [--seed N]" << std::endl;
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << option << std::endl;
+            return 2;
+        }
+        std::string value = argv[++i];
+        if (option == "--out") {
+            settings.out = value;
+        } else if (option == "--optimizers") {
+            settings.optimizers = split_list(value);
+        } else if (option == "--functions") {
+            settings.functions = split_list(value);
+        } else if (option == "--dims") {
+            settings.dims.clear();
+            for (const std::string& d : split_list(value)) {
+                settings.dims.push_back(std::stoul(d));
+            }
+        } else if (option == "--sizes") {
+            settings.sizes.clear();
+            for (const std::string& s : split_list(value)) {
+                settings.sizes.push_back(std::stoi(s));
+            }
+        } else if (option == "--iterations") {
+            settings.iterations = std::stoi(value);
+        } else if (option == "--tpe-iterations") {
+            settings.tpe_iterations = std::stoi(value);
+        } else if (option == "--target") {
+            settings.target = std::stod(value);
+        } else if (option == "--repeats") {
+            settings.repeats = std::stoi(value);
+        } else if (option == "--seed") {
+            settings.seed = std::stoll(value);
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 2;
+        }
+    }
+
+    size_t n_continuous;
+    const ContinuousFunction* continuous = continuous_functions(n_continuous);
+    std::vector<std::string> records;
+
+    for (const std::string& optimizer : settings.optimizers) { // For each optimizer...
+        if (optimizer != "pso" && optimizer != "genetic" && optimizer != "anneal" && optimizer != "tpe") {
+            std::cerr << "Unknown optimizer " << optimizer << std::endl;
+            return 2;
+        }
+        // Anneal has no population - it runs once per dimension, taking as many steps as the largest population takes evaluations
+        std::vector<int> sizes = settings.sizes;
+        if (optimizer == "anneal") {
+            sizes = {0};
+        }
+        int largest = settings.sizes.empty() ? 1 : *std::max_element(settings.sizes.begin(), settings.sizes.end());
+
+        for (const std::string& name : settings.functions) { // For each test function...
+            const ContinuousFunction* function = nullptr;
+            for (size_t f = 0; f < n_continuous; ++f) {
+                if (name == continuous[f].name) {
+                    function = &continuous[f];
+                }
+            }
+            if (function == nullptr && name != "onemax" && name != "string_match") {
+                std::cerr << "Unknown function " << name << std::endl;
+                return 2;
+            }
+            if (function == nullptr && (optimizer == "pso" || optimizer == "tpe")) { // If the optimizer only takes doubles...
+                continue;
+            }
+
+            for (size_t dim : settings.dims) { // For each dimension...
+                for (int size : sizes) { // For each population size...
+                    for (int repeat = 0; repeat < settings.repeats; ++repeat) { // For each repeat...
+                        Run run;
+                        run.optimizer = optimizer;
+                        run.function = name;
+                        run.dim = dim;
+                        run.size = size;
+                        run.repeat = repeat;
+                        run.seed = case_seed(settings.seed, run);
+                        run.iterations = optimizer == "tpe" ? settings.tpe_iterations : optimizer == "anneal" ? settings.iterations * largest : settings.iterations;
+
+                        std::string record = run_isolated([&]() -> std::string {
+                            if (function != nullptr) {
+                                run.type = "double";
+                                return run_continuous(settings, run, *function);
+                            }
+                            if (name == "onemax") {
+                                run.type = "int";
+                                Probe<int> probe{onemax, settings.target};
+                                return run_discrete<int>(run, probe, [dim](std::mt19937& rng) { return random_bits(dim, rng); });
+                            }
+                            run.type = "string";
+                            Probe<std::string> probe{string_match, settings.target};
+                            return run_discrete<std::string>(run, probe, [dim](std::mt19937& rng) { return random_words(dim, rng); });
+                        });
+                        std::cerr << record << std::endl; // Report progress
+                        records.push_back(record);
+                    }
+                }
+            }
+        }
+    }
+
+    std::ostringstream json; // Whole report
+    json << "{\n  \"quickopt_version\": \"" << QUICKOPT_VERSION << "\",\n  \"target\": " << settings.target << ",\n  \"runs\": [\n";
+    for (size_t r = 0; r < records.size(); ++r) {
+        json << "    " << records[r] << (r + 1 < records.size() ? ",\n" : "\n");
+    }
+    json << "  ]\n}\n";
+
+    if (settings.out.empty()) {
+        std::cout << json.str();
+    } else {
+        FILE* file = std::fopen(settings.out.c_str(), "w");
+        if (file == nullptr || std::fputs(json.str().c_str(), file) < 0 || std::fclose(file) != 0) {
+            std::cerr << "Failed to write " << settings.out << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <string>
+
+namespace quickopt {
+namespace bench {
+
+// Standard test functions, to be minimized - each has a global minimum of 0
+// Continuous functions take doubles within their search box, and the discrete ones take 0/1 integers and strings
+
+// Sphere - sum of squares, unimodal and separable
+inline double sphere(const double* x, size_t n) {
+    double sum = 0;
+    for (size_t i = 0; i < n; ++i) {
+        sum += x[i] * x[i];
+    }
+    return sum;
+}
+
+// Rastrigin - a sphere with a regular grid of local minima
+inline double rastrigin(const double* x, size_t n) {
+    double sum = 10.0 * n;
+    for (size_t i = 0; i < n; ++i) {
+        sum += x[i] * x[i] - 10.0 * std::cos(2 * M_PI * x[i]);
+    }
+    return sum;
+}
+
+// Ackley - nearly flat outer region around a deep central funnel
+inline double ackley(const double* x, size_t n) {
+    double squares = 0, cosines = 0;
+    for (size_t i = 0; i < n; ++i) {
+        squares += x[i] * x[i];
+        cosines += std::cos(2 * M_PI * x[i]);
+    }
+    return -20.0 * std::exp(-0.2 * std::sqrt(squares / n)) - std::exp(cosines / n) + 20.0 + M_E;
+}
+
+// Rosenbrock - a narrow curved valley, minimized at (1, ..., 1)
+inline double rosenbrock(const double* x, size_t n) {
+    double sum = 0;
+    for (size_t i = 0; i + 1 < n; ++i) {
+        double a = x[i + 1] - x[i] * x[i], b = 1 - x[i];
+        sum += 100.0 * a * a + b * b;
+    }
+    return sum;
+}
+
+// Griewank - many shallow local minima on a wide quadratic bowl
+inline double griewank(const double* x, size_t n) {
+    double sum = 0, product = 1;
+    for (size_t i = 0; i < n; ++i) {
+        sum += x[i] * x[i] / 4000.0;
+        product *= std::cos(x[i] / std::sqrt(i + 1.0));
+    }
+    return sum - product + 1.0;
+}
+
+// Schwefel - deceptive, with the global minimum near the corner (420.9687, ..., 420.9687), far from the next best minima
+inline double schwefel(const double* x, size_t n) {
+    double sum = 418.9828872724338 * n;
+    for (size_t i = 0; i < n; ++i) {
+        sum -= x[i] * std::sin(std::sqrt(std::fabs(x[i])));
+    }
+    return sum;
+}
+
+// OneMax - number of 0 genes in a 0/1 genome
+inline double onemax(const int* x, size_t n) {
+    double zeros = 0;
+    for (size_t i = 0; i < n; ++i) {
+        zeros += x[i] == 0;
+    }
+    return zeros;
+}
+
+// Word every string parameter of string_match is compared to
+inline const std::string& match_word() {
+    static const std::string word = "quickopt";
+    return word;
+}
+
+// String match - number of characters differing from match_word(), counting each missing or extra character as one
+inline double string_match(const std::string* x, size_t n) {
+    const std::string& word = match_word();
+    double distance = 0;
+    for (size_t i = 0; i < n; ++i) {
+        size_t common = std::min(x[i].size(), word.size());
+        for (size_t c = 0; c < common; ++c) {
+            distance += x[i][c] != word[c];
+        }
+        distance += std::max(x[i].size(), word.size()) - common;
+    }
+    return distance;
+}
+
+// Continuous test function with its search box
+struct ContinuousFunction {
+    const char* name;
+    double (*f)(const double*, size_t);
+    double low, high; // Bounds of every parameter
+};
+
+// Every continuous test function, with its usual search box
+inline const ContinuousFunction* continuous_functions(size_t& count) {
+    static const ContinuousFunction functions[] = {
+        {"sphere", sphere, -5.12, 5.12},
+        {"rastrigin", rastrigin, -5.12, 5.12},
+        {"ackley", ackley, -32.768, 32.768},
+        {"rosenbrock", rosenbrock, -5.0, 10.0},
+        {"griewank", griewank, -600.0, 600.0},
+        {"schwefel", schwefel, -500.0, 500.0},
+    };
+    count = sizeof(functions) / sizeof(functions[0]);
+    return functions;
+}
+
+} // namespace bench
+} // namespace quickopt
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+
+namespace quickopt {
+
+// Printable ASCII characters, the default alphabet of string operators
+inline std::string printable_ascii() {
+    std::string chars;
+    for (char c = ' '; c <= '~'; ++c) {
+        chars.push_back(c);
+    }
+    return chars;
+}
+
+} // namespace quickopt
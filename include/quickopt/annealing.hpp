@@ -0,0 +1,511 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "alphabet.hpp"
+#include "checkpoint.hpp"
+#include "random.hpp"
+#include "stats.hpp"
+#include "termination.hpp"
+#include "thread_pool.hpp"
+
+namespace quickopt {
+
+// Candidate class to store parameters that have been accepted as well as their values
+template <typename T>
+class Candidate {
+public:
+    std::vector<T> params; // Parameters for each candidate solution
+    double value; // Value of each candidate solution
+
+    Candidate(const std::vector<T>& p, double v) : params(p), value(v) {}
+};
+
+// Temperature schedule, acceptance rule and neighbor generator of simulated annealing - built-in operators run without leaving C++, and each may instead be a custom function
+// Schedule: "geometric" (t0, alpha), "linear" (t0, t_min, steps), "logarithmic" (t0), and the adaptive "lam" (t0, steps)
+// Acceptance: "metropolis"
+// Neighbor: "gaussian" (sigma, low, high) for doubles, "integer_step" (step, low, high) for integers, and "string_edit" (alphabet) for strings
+template <typename T>
+struct AnnealOperators {
+    enum class Schedule { custom, geometric, linear, logarithmic, lam }; // Built-in temperature schedules, or a custom function
+    enum class Acceptance { custom, metropolis }; // Built-in acceptance rules, or a custom function
+    enum class Neighbor { custom, gaussian, integer_step, string_edit }; // Built-in neighbor generators, or a custom function
+
+    bool adaptive() const { return schedule == Schedule::lam; } // Whether the temperature follows the acceptance rate, and so may rise
+
+    // Temperature at an iteration - the Lam schedule also takes the current temperature and the recent acceptance rate
+    double temperature(int iter, double current, double accept_rate) const {
+        switch (schedule) {
+        case Schedule::geometric:
+            return t0 * std::pow(alpha, iter);
+        case Schedule::linear:
+            return t0 + (t_min - t0) * std::min(1.0, static_cast<double>(iter) / steps);
+        case Schedule::logarithmic:
+            return t0 * std::log(2.0) / std::log(iter + 2.0);
+        case Schedule::lam: {
+            // Nudge the temperature so the acceptance rate tracks the Lam-Delosme target, as modified by Swartz
+            if (iter == 0) {
+                return t0;
+            }
+            double s = static_cast<double>(iter) / steps; // Fraction of the run elapsed
+            double target; // Target acceptance rate
+            if (s < 0.15) {
+                target = 0.44 + 0.56 * std::pow(560.0, -s / 0.15);
+            } else if (s < 0.65) {
+                target = 0.44;
+            } else {
+                target = 0.44 * std::pow(440.0, -(s - 0.65) / 0.35);
+            }
+            return accept_rate > target ? current * 0.999 : current / 0.999;
+        }
+        default:
+            return custom_temperature(iter);
+        }
+    }
+
+    // Probability of accepting a proposal
+    double acceptance(double new_value, double current_value, double temperature) const {
+        if (rule == Acceptance::metropolis) { // Always accept improvements, and worse proposals with Boltzmann probability
+            return new_value < current_value ? 1.0 : std::exp(-(new_value - current_value) / temperature);
+        }
+        return custom_acceptance(new_value, current_value, temperature);
+    }
+
+    // Generate a new set of parameters based on the current set
+    std::vector<T> neighbor(const std::vector<T>& params, std::mt19937& rng) const {
+        if (move == Neighbor::custom) { // If the generator is a custom function...
+            return custom_neighbor(params);
+        }
+        std::vector<T> next = params;
+        if (next.empty()) { // If there is nothing to change...
+            return next;
+        }
+        if constexpr (std::is_same<T, double>::value) { // Step every parameter by Gaussian noise
+            std::normal_distribution<double> noise(0.0, sigma);
+            for (double& p : next) {
+                p = std::min(high, std::max(low, p + noise(rng)));
+            }
+        } else if constexpr (std::is_integral<T>::value) { // Step one parameter by a nonzero amount of at most step
+            std::uniform_int_distribution<size_t> pick(0, next.size() - 1);
+            std::uniform_int_distribution<int> amount(1, step_size);
+            T& p = next[pick(rng)];
+            double stepped = static_cast<double>(p) + (rng() & 1 ? amount(rng) : -amount(rng));
+            p = static_cast<T>(std::min(high, std::max(low, stepped)));
+        } else { // Substitute, insert or delete one character of one parameter
+            std::uniform_int_distribution<size_t> pick(0, next.size() - 1);
+            std::uniform_int_distribution<size_t> letter(0, alphabet.size() - 1);
+            std::string& p = next[pick(rng)];
+            int edit = p.empty() ? 1 : static_cast<int>(rng() % 3); // Empty strings can only grow
+            if (edit == 0) { // Substitute a character
+                p[std::uniform_int_distribution<size_t>(0, p.size() - 1)(rng)] = alphabet[letter(rng)];
+            } else if (edit == 1) { // Insert a character
+                p.insert(p.begin() + std::uniform_int_distribution<size_t>(0, p.size())(rng), alphabet[letter(rng)]);
+            } else { // Delete a character
+                p.erase(std::uniform_int_distribution<size_t>(0, p.size() - 1)(rng), 1);
+            }
+        }
+        return next;
+    }
+
+    Schedule schedule = Schedule::geometric;
+    Acceptance rule = Acceptance::metropolis;
+    Neighbor move = Neighbor::custom;
+    std::function<double(int)> custom_temperature; // Custom temperature schedule - temperature at an iteration
+    std::function<double(double, double, double)> custom_acceptance; // Custom acceptance rule - probability of accepting a new value over the current value at a temperature
+    std::function<std::vector<T>(const std::vector<T>&)> custom_neighbor; // Custom neighbor generator - new set of parameters based on the current set
+    double t0 = 1.0; // Initial temperature
+    double alpha = 0.999; // Geometric cooling factor
+    double t_min = 1e-3; // Final temperature of the linear schedule
+    int steps = 0; // Number of iterations spanned by the linear and Lam schedules
+    double sigma = 0.1; // Standard deviation of Gaussian steps
+    int step_size = 1; // Largest integer step
+    double low = std::numeric_limits<double>::lowest(); // Lowest value of a numeric parameter
+    double high = std::numeric_limits<double>::max(); // Highest value of a numeric parameter
+    std::string alphabet = printable_ascii(); // Characters of string edits
+};
+
+// Markov chain of simulated annealing - stores the current and best candidates, and decides whether to accept each proposal
+template <typename T>
+class AnnealChain {
+public:
+    AnnealChain(const std::vector<T>& initial, const AnnealOperators<T>& operators, uint64_t seed)
+        : current(initial, 0), best(initial, 0), operators(operators), rng(static_cast<std::mt19937::result_type>(seed)), dist(0.0, 1.0) {}
+
+    // Record the value of the initial guess
+    void start(double value) {
+        current.value = value; // Set the current candidate as the initial guess
+        best.value = value; // Set the best candidate as the initial guess
+        if (!held) { // If the chain follows the schedule...
+            temp = operators.temperature(0, temp, accept_rate); // Initial temperature
+        }
+    }
+
+    // Fix the chain at a temperature instead of following the schedule, as replicas of parallel tempering do
+    void hold(double fixed) {
+        temp = fixed;
+        held = true;
+    }
+
+    double temperature_now() const { return temp; } // Current temperature
+
+    // Generate a new set of parameters based on the current set, for a given iteration
+    std::vector<T> propose(int iter) {
+        if (!held) { // If the chain follows the schedule...
+            double new_temp = operators.temperature(iter, temp, accept_rate); // Calculate the temperature for the current iteration
+            if (new_temp > temp && !operators.adaptive()) {
+                std::cerr << "Warning: Temperature must be decreasing. Current temperature: " << new_temp << " Previous temperature: " << temp << std::endl;
+            }
+            temp = new_temp; // Update the temperature
+        }
+
+        return operators.neighbor(current.params, rng); // Generate a new set of parameters based on the current set
+    }
+
+    // Record the value of a proposal, updating the best candidate and accepting or rejecting it
+    void step(const std::vector<T>& new_params, double new_val) {
+        if (new_val < best.value) { // If the new set of parameters is better than the best set of parameters...
+            best = Candidate<T>(new_params, new_val); // Set the new set of parameters as the best candidate
+        }
+
+        double prob = operators.acceptance(new_val, current.value, temp);
+        if (prob < 0.0 || prob > 1.0) { // If the acceptance probability is not within 0 and 1..
+            throw std::invalid_argument("Acceptance probability must fall between 0 and 1!"); // Throw an exception
+        }
+
+        bool accepted = dist(rng) < prob;
+        if (accepted) { // If the new set of parameters is accepted...
+            current = Candidate<T>(new_params, new_val); // Set the new set of parameters as the current set
+        }
+        accept_rate = 0.998 * accept_rate + 0.002 * accepted; // Track the recent acceptance rate over roughly 500 iterations
+    }
+
+    // Write the candidates, the temperature and the random number generator to a checkpoint
+    void save(CheckpointWriter& out) const {
+        out.write(current.params);
+        out.write(current.value);
+        out.write(best.params);
+        out.write(best.value);
+        out.write(temp);
+        out.write(accept_rate);
+        out.write(held);
+        out.write_random(rng);
+    }
+
+    // Restore a state written by save()
+    void load(CheckpointReader& in) {
+        in.read(current.params);
+        in.read(current.value);
+        in.read(best.params);
+        in.read(best.value);
+        in.read(temp);
+        in.read(accept_rate);
+        in.read(held);
+        in.read_random(rng);
+    }
+
+    Candidate<T> current; // Current accepted guess
+    Candidate<T> best; // Best guess so far
+
+private:
+    const AnnealOperators<T>& operators; // Schedule, acceptance rule and neighbor generator
+    double temp = 0; // Current temperature
+    double accept_rate = 0.5; // Recent acceptance rate
+    bool held = false; // Whether the temperature is fixed
+    std::mt19937 rng; // Random number generator
+    std::uniform_real_distribution<> dist; // Uniform distribution for acceptance probability
+};
+
+// Replica exchange (parallel tempering) - runs one chain at each temperature of the ladder, and every swap_interval sweeps
+// offers adjacent chains to trade states with the Metropolis criterion, so good states found by hot chains sink to the cold ones
+// With parallel set, the chains step in parallel threads with a Release guard held, each evaluating its own proposal; otherwise each sweep
+// proposes a set of parameters for every chain and evaluates them all in a single call
+template <typename Release = NoRelease, typename T, typename EvaluateBatch>
+Candidate<T> temper(
+    EvaluateBatch&& evaluate, // Calculates the values of sets of parameters - called as evaluate(const T* points, size_t count, size_t n, double* values) with count row-major sets of n parameters, once per sweep, or with one set at a time from several threads if parallel
+    bool parallel, // Whether to step the chains in parallel threads - evaluate and the operators must then be thread-safe
+    const std::vector<T>& initial, // Initial guess shared by every chain
+    const AnnealOperators<T>& operators, // Acceptance rule and neighbor generator - the chains hold the temperatures of the ladder instead of following the schedule
+    const std::vector<double>& ladder, // Temperature of each chain
+    int iterations, // Number of sweeps - every chain takes one step per sweep
+    int swap_interval, // Number of sweeps between exchanges
+    int verbose, // Verbosity level
+    size_t& swap_attempts, // Number of exchanges offered
+    size_t& swaps, // Number of exchanges accepted
+    Monitor* monitor = nullptr, // Collects stats and per-sweep records, or null
+    const Checkpoint* checkpoint = nullptr, // Where the chains are saved and resumed from, or null
+    Termination* termination = nullptr, // Budgets and convergence tests that may end the run early, and the reason it ended, or null
+    long long rng_seed = -1 // Seed the random number generator of every chain is derived from - negative for nondeterministic seeds
+) {
+    size_t replicas = ladder.size(); // Number of chains
+    std::vector<AnnealChain<T>> chains; // Chain at each temperature
+    chains.reserve(replicas);
+    Stats* stats = stats_of(monitor); // Per-phase timers, or null
+
+    // Calculate the values of count row-major sets of n parameters
+    auto values_of = [&](const T* points, size_t count, size_t n, double* values) {
+        PhaseTimer timer(stats, Phase::objective);
+        if (stats != nullptr) {
+            stats->count_evaluations(count);
+        }
+        if (termination != nullptr) {
+            termination->count_evaluations(count);
+        }
+        evaluate(points, count, n, values);
+    };
+
+    // Calculate the value of a set of parameters
+    auto value_of = [&](const std::vector<T>& params) {
+        double value;
+        values_of(params.data(), 1, params.size(), &value);
+        return value;
+    };
+    if (termination != nullptr) {
+        termination->start(false); // Annealing minimizes
+        if (termination->measures_diversity()) { // If a spread was asked for, which a chain does not have...
+            throw std::invalid_argument("Diversity threshold requires a swarm or population!"); // Throw an exception
+        }
+    }
+
+    std::unique_ptr<ThreadPool> pool(parallel ? new ThreadPool(static_cast<int>(replicas)) : nullptr); // One thread per chain
+    uint64_t base_seed = run_seed(rng_seed); // Seed every chain's random number stream, and that of the exchanges, is derived from
+    std::mt19937 rng(static_cast<std::mt19937::result_type>(stream_seed(base_seed, replicas))); // Random number generator for exchanges
+    std::uniform_real_distribution<> dist(0.0, 1.0);
+    int start = 0; // First sweep to run
+
+    if (checkpoint != nullptr && checkpoint->resumable()) { // If the chains were saved...
+        CheckpointReader in(checkpoint->path, "temper");
+        start = in.read<int32_t>(); // Number of sweeps completed
+        CheckpointReader::expect<uint64_t>(in.read<uint64_t>(), replicas, "number of replicas");
+        swap_attempts = in.read<uint64_t>();
+        swaps = in.read<uint64_t>();
+        in.read_random(rng);
+        for (size_t r = 0; r < replicas; ++r) { // For each temperature...
+            chains.emplace_back(initial, operators, stream_seed(base_seed, r));
+            chains[r].load(in); // Restore its chain
+        }
+    } else { // If not...
+        double initial_value = value_of(initial); // Calculate the value of the initial guess
+        for (size_t r = 0; r < replicas; ++r) { // For each temperature...
+            chains.emplace_back(initial, operators, stream_seed(base_seed, r)); // Create its chain, starting at the initial guess
+            chains[r].hold(ladder[r]); // Fix it at its temperature
+            chains[r].start(initial_value);
+        }
+    }
+
+    // Save the chains after the sweeps [before, after) if a save is due or the run has ended
+    auto save = [&](int before, int after, bool stopped) {
+        if (checkpoint == nullptr || (!checkpoint->due(before, after) && after < iterations && !stopped)) { // If no save is due...
+            return;
+        }
+        CheckpointWriter out("temper");
+        out.write(static_cast<int32_t>(after));
+        out.write(static_cast<uint64_t>(replicas));
+        out.write(static_cast<uint64_t>(swap_attempts));
+        out.write(static_cast<uint64_t>(swaps));
+        out.write_random(rng);
+        for (const AnnealChain<T>& chain : chains) { // For each chain...
+            chain.save(out);
+        }
+        out.commit(checkpoint->path);
+    };
+
+    // For every sweep...
+    for (int iter = start; iter < iterations; ++iter) {
+        if (parallel) { // If the chains step in parallel...
+            // Take one step of a chain
+            auto step = [&](size_t r, size_t) {
+                std::vector<T> new_params;
+                {
+                    PhaseTimer timer(stats, Phase::neighbor);
+                    new_params = chains[r].propose(iter); // Generate a new set of parameters based on the current set
+                }
+                double new_val = value_of(new_params); // Calculate the value of the new set of parameters
+                PhaseTimer timer(stats, Phase::acceptance);
+                chains[r].step(new_params, new_val); // Update the best candidate and decide whether to accept the new set of parameters
+            };
+            Release release; // Let go of the caller's lock while the threads step
+            pool->parallel_for(replicas, step);
+        } else { // If not...
+            std::vector<std::vector<T>> proposals(replicas); // New set of parameters of each chain
+            {
+                PhaseTimer timer(stats, Phase::neighbor);
+                for (size_t r = 0; r < replicas; ++r) { // For each chain...
+                    proposals[r] = chains[r].propose(iter); // Generate a new set of parameters based on its current set
+                }
+            }
+            size_t n = proposals[0].size(); // Number of parameters of every set
+            std::vector<T> rows; // Proposals of every chain, one row per chain
+            rows.reserve(replicas * n);
+            for (const std::vector<T>& proposal : proposals) { // For each proposal...
+                if (proposal.size() != n) { // If it cannot share a row-major batch...
+                    throw std::invalid_argument("Every replica's parameters must have the same length!"); // Throw an exception
+                }
+                rows.insert(rows.end(), proposal.begin(), proposal.end());
+            }
+            std::vector<double> new_vals(replicas); // Value of each proposal
+            values_of(rows.data(), replicas, n, new_vals.data()); // Calculate the values of every proposal in a single call
+            PhaseTimer timer(stats, Phase::acceptance);
+            for (size_t r = 0; r < replicas; ++r) { // For each chain...
+                chains[r].step(proposals[r], new_vals[r]); // Update the best candidate and decide whether to accept its new set of parameters
+            }
+        }
+
+        if ((iter + 1) % swap_interval == 0) { // If it is time for an exchange...
+            PhaseTimer timer(stats, Phase::acceptance);
+            // Offer alternately the even and the odd pairs of adjacent temperatures, so every pair is independent
+            for (size_t k = ((iter + 1) / swap_interval) % 2; k + 1 < replicas; k += 2) { // For each pair...
+                AnnealChain<T>& a = chains[k];
+                AnnealChain<T>& b = chains[k + 1];
+                double delta = (1.0 / a.temperature_now() - 1.0 / b.temperature_now()) * (a.current.value - b.current.value); // Log acceptance ratio of the exchange
+                swap_attempts++;
+                if (delta >= 0 || dist(rng) < std::exp(delta)) { // If the exchange is accepted...
+                    std::swap(a.current, b.current); // Trade the states, keeping the temperatures
+                    swaps++;
+                }
+            }
+        }
+
+        double best = chains[0].best.value; // Best value of every chain
+        for (const AnnealChain<T>& chain : chains) {
+            best = std::min(best, chain.best.value);
+        }
+        if (monitor != nullptr && monitor->recording()) { // If the records replace the output...
+            monitor->record(iter, best, chains.back().current.value);
+        } else if (verbose == 1) {
+            std::cout << "Iteration: " << iter << " Best value: " << best << std::endl; // Output the iteration number and the best value
+            std::cout << "Coldest current value: " << chains.back().current.value << std::endl; // Output the current value of the coldest chain
+        }
+        bool stopped = termination != nullptr && termination->stop(iter + 1, best); // Whether the run ends early
+        save(iter, iter + 1, stopped);
+        if (stopped) {
+            break;
+        }
+    }
+
+    if (monitor != nullptr) {
+        monitor->flush(); // Pass on the remaining records
+    }
+    Candidate<T> best = chains[0].best; // Best candidate of every chain
+    for (const AnnealChain<T>& chain : chains) {
+        if (chain.best.value < best.value) {
+            best = chain.best;
+        }
+    }
+    if (verbose >= 0 && (monitor == nullptr || !monitor->recording())) { // If the user wants final output, and the records do not replace it...
+        std::cout << "Best value: " << best.value << std::endl;
+    }
+    return best;
+}
+
+// Temperatures of replicas spaced geometrically from the hottest to the coldest temperature of a schedule over a run
+template <typename T>
+std::vector<double> default_ladder(const AnnealOperators<T>& operators, int replicas, int iterations) {
+    if (operators.adaptive()) { // If the schedule depends on the acceptance rate...
+        throw std::invalid_argument("Adaptive schedules require a ladder for replica exchange!"); // Throw an exception
+    }
+    double hot = operators.temperature(0, 0, 0); // Temperature of the hottest replica
+    double cold = operators.temperature(iterations, 0, 0); // Temperature of the coldest replica
+    std::vector<double> ladder;
+    for (int r = 0; r < replicas; ++r) { // For each replica...
+        ladder.push_back(replicas > 1 ? hot * std::pow(cold / hot, static_cast<double>(r) / (replicas - 1)) : hot);
+    }
+    return ladder;
+}
+
+// Simulated annealing of a single chain - returns the best candidate found
+template <typename T, typename Evaluate>
+Candidate<T> anneal(
+    Evaluate&& evaluate, // Calculates the value of a set of parameters - called as evaluate(const T* params, size_t n)
+    const std::vector<T>& initial, // Initial guess - the starting set of parameters for simulated annealing process
+    const AnnealOperators<T>& operators, // Temperature schedule, acceptance rule and neighbor generator
+    int iterations = 100, // Number of iterations to run the algorithm for
+    int verbose = 0, // Verbosity level - -1 for no output, 0 for final output, 1 for output at each iteration
+    Monitor* monitor = nullptr, // Collects stats and per-iteration records, or null
+    const Checkpoint* checkpoint = nullptr, // Where the chain is saved and resumed from, or null
+    Termination* termination = nullptr, // Budgets and convergence tests that may end the run early, and the reason it ended, or null
+    long long rng_seed = -1 // Seed for the random number generator - negative for a nondeterministic seed
+) {
+    Stats* stats = stats_of(monitor); // Per-phase timers, or null
+
+    // Calculate the value of a set of parameters
+    auto value_of = [&](const std::vector<T>& params) {
+        PhaseTimer timer(stats, Phase::objective);
+        if (stats != nullptr) {
+            stats->count_evaluations(1);
+        }
+        if (termination != nullptr) {
+            termination->count_evaluations(1);
+        }
+        return evaluate(params.data(), params.size());
+    };
+    if (termination != nullptr) {
+        termination->start(false); // Annealing minimizes
+        if (termination->measures_diversity()) { // If a spread was asked for, which a chain does not have...
+            throw std::invalid_argument("Diversity threshold requires a swarm or population!"); // Throw an exception
+        }
+    }
+
+    AnnealChain<T> chain(initial, operators, mix_seed(run_seed(rng_seed))); // Create the chain, starting at the initial guess provided
+    int start = 0; // First iteration to run
+    if (checkpoint != nullptr && checkpoint->resumable()) { // If the chain was saved...
+        CheckpointReader in(checkpoint->path, "anneal");
+        start = in.read<int32_t>(); // Number of iterations completed
+        chain.load(in); // Restore the chain
+    } else { // If not...
+        chain.start(value_of(initial)); // Calculate the value of the initial guess
+    }
+
+    // For every iteration...
+    for (int iter = start; iter < iterations; ++iter) {
+        std::vector<T> new_params;
+        {
+            PhaseTimer timer(stats, Phase::neighbor);
+            new_params = chain.propose(iter); // Generate a new set of parameters based on the current set
+        }
+        double new_val = value_of(new_params); // Calculate the value of the new set of parameters
+
+        if (monitor != nullptr && monitor->recording()) { // If the records replace the output...
+            monitor->record(iter, std::min(chain.best.value, new_val), chain.current.value);
+        } else if (verbose == 1) {
+            std::cout << "Iteration: " << iter << " Best value: " << std::min(chain.best.value, new_val) << std::endl; // Output the iteration number and the best value
+            std::cout << "Current value: " << chain.current.value << std::endl; // Output the current value
+            std::cout << "Best value: " << std::min(chain.best.value, new_val) << std::endl; // Output the best value
+        }
+
+        {
+            PhaseTimer timer(stats, Phase::acceptance);
+            chain.step(new_params, new_val); // Update the best candidate and decide whether to accept the new set of parameters
+        }
+
+        bool stopped = termination != nullptr && termination->stop(iter + 1, chain.best.value); // Whether the run ends early
+        if (checkpoint != nullptr && (checkpoint->due(iter, iter + 1) || iter + 1 == iterations || stopped)) { // If a save is due or the run has ended...
+            CheckpointWriter out("anneal");
+            out.write(static_cast<int32_t>(iter + 1));
+            chain.save(out);
+            out.commit(checkpoint->path);
+        }
+        if (stopped) {
+            break;
+        }
+    }
+
+    if (monitor != nullptr) {
+        monitor->flush(); // Pass on the remaining records
+    }
+    if (verbose >= 0) {
+        std::cout << "Best value: " << chain.best.value << std::endl;
+    }
+    return chain.best;
+}
+
+} // namespace quickopt
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "random.hpp"
+#include "stats.hpp"
+#include "termination.hpp"
+#include "thread_pool.hpp"
+#include "tpe.hpp"
+
+namespace quickopt {
+
+// Number of budget levels above the smallest in Hyperband, floor(log_eta(max_budget / min_budget)) - a small epsilon keeps exact powers of eta from rounding down
+inline int hyperband_levels(double min_budget, double max_budget, double eta) {
+    return static_cast<int>(std::floor(std::log(max_budget / min_budget) / std::log(eta) + 1e-9));
+}
+
+// Multi-fidelity Bayesian optimization (BOHB) - Hyperband's successive-halving brackets, with new configurations proposed by TPE - returns the best parameters found
+// evaluate(params, dim, budget) returns the value of the parameters evaluated with a given budget (e.g. epochs or a fraction of the data), to be *minimized*
+// Each iteration runs one bracket: it evaluates n configurations at its smallest budget, then repeatedly keeps the best 1 / eta of them and evaluates those with eta times the budget, up to max_budget
+// The brackets cycle from the most aggressive, which starts at min_budget, to plain evaluation at max_budget, so a misleading small budget cannot discard every good configuration
+// Every evaluation is kept in a TPE model of its budget, and new configurations are proposed from the model of the largest budget with at least min_points evaluations
+// This is based on Falkner et al. 2018, with Hyperband from Li et al. 2018
+template <typename Release = NoRelease, typename Evaluate>
+std::vector<double> bohb(
+    Evaluate&& evaluate, // Evaluates a configuration - called as evaluate(const double* params, size_t dim, double budget), returning its value
+    std::vector<double> space_min, // Lower bound vector for the search space
+    std::vector<double> space_max, // Upper bound vector for the search space
+    double min_budget = 1, // Smallest budget a configuration is evaluated with
+    double max_budget = 27, // Largest budget a configuration is evaluated with
+    double eta = 3, // Factor the budget grows by, and the number of configurations shrinks by, at each rung of a bracket
+    int iterations = 10, // Number of brackets to run
+    double random_fraction = 1.0 / 3.0, // Fraction of configurations drawn uniformly instead of proposed by the model, which keeps the search global
+    int min_points = 0, // Number of evaluations a budget needs before its model proposes configurations - 0 for the number of parameters plus 2
+    int acquisition_samples = 100, // Number of samples to draw for acquisition function maximization
+    int verbose = 0, // Verbosity level - 1 outputs each evaluation and the best value
+    double threshold = 0.5, // Threshold value for the splitting function - unnecessary if split is provided
+    int group_cap = 9999, // Group cap for the good set
+    std::vector<double> bandwidth = std::vector<double>(), // Optional bandwidth vector for the KDE (overrides dynamic bandwidth calculation)
+    int prior_weight = 1, // Prior weight parameter for Non-Informative Prior
+    double split = -107.2931, // Optional splitting threshold (overrides dynamic threshold calculation)
+    const std::string& kde = "exact", // Kernel density estimation method - "exact" sums every candidate, "tree" approximates large sets with KD-trees
+    double kde_tolerance = 1e-3, // Maximum relative error of each density when kde is "tree"
+    int n_threads = 1, // Number of threads used to generate and score acquisition samples, and to evaluate rungs in parallel - 0 uses every hardware thread
+    long long rng_seed = -1, // Seed for the random number generator - negative for a nondeterministic seed
+    bool parallel = false, // Whether to evaluate the configurations of each rung in parallel threads - evaluate must then be thread-safe
+    Monitor* monitor = nullptr, // Collects stats and a record per evaluated configuration, or null
+    const std::string& sampling = "uniform", // How acquisition samples are drawn - "uniform" over the search space, or "mixture" from the good set's density and the prior
+    Termination* termination = nullptr // Budgets and convergence tests checked after each rung, which may end the run early, and the reason it ended, or null
+) {
+
+    size_t dim = space_min.size(); // Number of parameters
+    if (min_points == 0) { // If the number of evaluations per model is not given...
+        min_points = static_cast<int>(dim) + 2; // Use enough for a good set of two and a non-empty bad set in every dimension, as in Falkner et al. 2018
+    }
+
+    // Check for invalid inputs
+    if (!(min_budget > 0)) { // If the smallest budget is not positive...
+        throw std::invalid_argument("Minimum budget must be positive!"); // Throw an exception
+    }
+    if (!(max_budget >= min_budget)) { // If the largest budget is below the smallest...
+        throw std::invalid_argument("Maximum budget must be at least the minimum budget!"); // Throw an exception
+    }
+    if (!(eta > 1)) { // If the budgets do not grow...
+        throw std::invalid_argument("Eta must be greater than 1!"); // Throw an exception
+    }
+    if (!(random_fraction >= 0 && random_fraction <= 1)) { // If the random fraction is not within the range [0, 1]...
+        throw std::invalid_argument("Random fraction must be within 0 and 1!"); // Throw an exception
+    }
+    if (min_points < 3) { // If a model could not have both a good and a bad set...
+        throw std::invalid_argument("Minimum number of points must be at least 3!"); // Throw an exception
+    }
+    check_tpe_settings(space_min, space_max, iterations, min_points, "min_points", acquisition_samples, threshold, group_cap, bandwidth, split, kde, kde_tolerance, n_threads, sampling);
+
+    bool dynam = bandwidth.size() != dim; // Whether each model's bandwidth is calculated from its number of evaluations
+
+    uint64_t base_seed = run_seed(rng_seed); // Seed every random number stream is derived from
+    std::mt19937 rng(static_cast<std::mt19937::result_type>(mix_seed(base_seed))); // Initialize the random number generator for the random configurations
+    std::uniform_real_distribution<double> coin(0.0, 1.0); // Decides whether a configuration is drawn at random
+    Stats* stats = stats_of(monitor); // Per-phase timers, or null
+
+    auto timed_evaluate = [&evaluate, stats, termination](const double* params, size_t dim, double budget) -> double { // Evaluate a configuration, timing the call and counting the evaluation
+        PhaseTimer timer(stats, Phase::objective);
+        double value = evaluate(params, dim, budget);
+        if (stats != nullptr) {
+            stats->count_evaluations(1);
+        }
+        if (termination != nullptr) {
+            termination->count_evaluations(1);
+        }
+        return value;
+    };
+    if (termination != nullptr) {
+        termination->start(false); // BOHB minimizes
+        if (termination->measures_diversity()) { // If a spread was asked for, which a set of trials does not have...
+            throw std::invalid_argument("Diversity threshold requires a swarm or population!"); // Throw an exception
+        }
+    }
+
+    int top = hyperband_levels(min_budget, max_budget, eta); // Index of the largest budget level - level l has budget max_budget * eta^(l - top)
+    std::vector<TPETrialStore> datasets; // Store of the trials evaluated with each budget level, sorted by value
+    std::vector<TPEKernelDensity> densities; // Kernel density estimate over each level's trials, kept in the same order
+    std::vector<TPEModel> models; // Weights and acquisition function fitted to each level's trials
+    ThreadPool pool(n_threads); // Threads used to generate and score the acquisition samples, and to evaluate rungs in parallel
+    for (int l = 0; l <= top; l++) { // For each budget level...
+        datasets.emplace_back(dim);
+        densities.emplace_back(dim, kde == "tree", kde_tolerance);
+        models.emplace_back(space_min, space_max, threshold, split, group_cap, prior_weight, acquisition_samples, sampling == "mixture", pool.size());
+    }
+
+    std::vector<std::uniform_real_distribution<double>> distributions; // Vector of uniform real distributions
+    for (size_t j = 0; j < dim; j++) { // For each dimension in the search space...
+        distributions.emplace_back(space_min[j], space_max[j]); // Add a uniform real distribution with the corresponding lower and upper bounds
+    }
+
+    uint64_t proposals = 0; // Number of configurations proposed by a model, which seeds each proposal's random number streams
+
+    // Propose a configuration from the TPE model of a budget level, writing it to params
+    auto propose = [&](int level, double* params) {
+        models[level].fit(datasets[level], densities[level], dynam ? tpe_bandwidth(space_min, space_max, datasets[level].size()) : bandwidth, stats); // Fit the model to the level's trials, with a bandwidth for their number if it is dynamic
+        models[level].propose<Release>(datasets[level], densities[level], pool, base_seed, proposals++, params, stats);
+    };
+
+    double bestValue = std::numeric_limits<double>::max(); // Best value at the largest budget evaluated so far
+    std::vector<double> bestParameters(dim, 0); // Parameters of the best value
+    int bestLevel = -1; // Budget level the best value was evaluated with - values of smaller budgets are not comparable
+
+    for (int i = 0; i < iterations; i++) { // For each bracket...
+        int s = top - i % (top + 1); // Number of rungs after the first - the bracket starts at level top - s
+        double first = std::ceil((top + 1.0) / (s + 1.0) * std::pow(eta, s) - 1e-9); // Number of configurations in the first rung
+        size_t n = static_cast<size_t>(first); // Number of configurations in the current rung
+
+        int model = -1; // Largest budget level with enough trials for a model, if any
+        for (int l = top; l >= 0 && model < 0; l--) { // For each budget level, largest first...
+            if (datasets[l].size() >= static_cast<size_t>(min_points)) { // If it has enough trials...
+                model = l;
+            }
+        }
+
+        std::vector<double> configs(n * dim); // Configurations of the rung, one row per configuration
+        for (size_t c = 0; c < n; c++) { // For each configuration of the first rung...
+            double* params = &configs[c * dim];
+            if (model < 0 || coin(rng) < random_fraction) { // If there is no model yet, or the configuration is drawn at random...
+                for (size_t j = 0; j < dim; j++) { // For each dimension in the search space...
+                    params[j] = distributions[j](rng); // Generate a random parameter value using the corresponding distribution
+                }
+            } else { // If not...
+                propose(model, params); // Propose it from the model
+            }
+        }
+
+        bool stopped = false; // Whether the run ends early
+        for (int k = 0; k <= s && !stopped; k++) { // For each rung of the bracket...
+            int level = top - s + k; // Budget level of the rung
+            double budget = max_budget * std::pow(eta, level - top); // Budget each configuration is evaluated with
+            std::vector<double> evals(n); // Value of each configuration
+            if (parallel) { // If the configurations are evaluated in parallel...
+                Release release; // Let go of the caller's lock while the threads evaluate
+                pool.parallel_for(n, [&](size_t c, size_t) {
+                    evals[c] = timed_evaluate(&configs[c * dim], dim, budget); // Evaluate the configuration
+                });
+            } else { // If not...
+                for (size_t c = 0; c < n; c++) { // For each configuration...
+                    evals[c] = timed_evaluate(&configs[c * dim], dim, budget); // Evaluate the configuration
+                }
+            }
+
+            if (level > bestLevel) { // If this is the largest budget evaluated so far...
+                bestLevel = level;
+                bestValue = std::numeric_limits<double>::max(); // The best values of smaller budgets no longer count
+            }
+            for (size_t c = 0; c < n; c++) { // For each configuration...
+                const double* params = &configs[c * dim];
+                if (level == bestLevel && evals[c] < bestValue) { // If the evaluation is better than the best value...
+                    bestValue = evals[c]; // Update the best value
+                    bestParameters.assign(params, params + dim); // Update the best parameters
+                }
+                {
+                    PhaseTimer timer(stats, Phase::kde);
+                    densities[level].insert(datasets[level].add(params, evals[c]), params); // Add the configuration to the model of its budget
+                }
+
+                if (monitor != nullptr && monitor->recording()) { // If the records replace the output...
+                    monitor->record(i, bestValue, evals[c]);
+                } else if (verbose == 1) { // If verbose output is enabled...
+                    std::cout << "Iteration " << i << ", budget " << budget << ": " << evals[c] << std::endl; // Print the iteration number, budget and evaluation
+                    std::cout << "Best value: " << bestValue << std::endl; // Print the best value
+                }
+            }
+
+            stopped = termination != nullptr && termination->stop(k == s ? i + 1 : i, bestValue); // Check after every rung, counting the bracket once it is complete
+            if (k == s || stopped) { // If the bracket is over...
+                break;
+            }
+
+            size_t kept = std::max<size_t>(1, static_cast<size_t>(std::floor(first * std::pow(eta, -(k + 1)) + 1e-9))); // Number of configurations promoted to the next rung
+            std::vector<double> promoted(kept * dim); // Configurations of the next rung
+            {
+                PhaseTimer timer(stats, Phase::sort);
+                std::vector<size_t> order(n); // Configurations of the rung in order of value
+                std::iota(order.begin(), order.end(), 0);
+                std::stable_sort(order.begin(), order.end(), [&evals](size_t a, size_t b) { return evals[a] < evals[b]; });
+                for (size_t c = 0; c < kept; c++) { // For each configuration promoted...
+                    std::copy(configs.begin() + order[c] * dim, configs.begin() + (order[c] + 1) * dim, promoted.begin() + c * dim);
+                }
+            }
+            configs.swap(promoted);
+            n = kept;
+        }
+        if (stopped) {
+            break;
+        }
+    }
+
+    if (monitor != nullptr) {
+        monitor->flush(); // Pass on the remaining records
+    }
+    return bestParameters; // Return the best parameters
+}
+
+} // namespace quickopt
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace quickopt {
+
+// Where an optimizer saves its state, how often, and whether it starts from the state already saved there
+// A run resumed from a checkpoint continues where the saved run stopped - with the same population, swarm, chains or trials, and the same
+// random number generator positions - and runs until the total number of iterations given to the optimizer
+struct Checkpoint {
+    std::string path; // File holding the state
+    int interval = 10; // Number of iterations between saves - the state is also saved when the run ends
+    bool resume = false; // Whether to restore the state saved at path, if the file exists
+
+    // Whether a save is due after the iterations [before, after) - both count completed iterations
+    bool due(int before, int after) const { return interval > 0 && after / interval > before / interval; }
+
+    // Whether there is a saved state to resume from
+    bool resumable() const { return resume && std::ifstream(path, std::ios::binary).good(); }
+};
+
+// Checkpoint files are "QOCKPT", a format version, a byte order mark, the kind of optimizer, its state, and an FNV-1a checksum of everything before it
+// Numbers are stored in the native byte order - a file written on a machine of the other byte order is rejected rather than misread
+const char checkpoint_magic[] = "QOCKPT"; // First bytes of every checkpoint file
+const uint32_t checkpoint_version = 1; // Format version - bumped whenever the layout of any state changes
+const uint32_t checkpoint_byte_order = 0x01020304; // Byte order mark
+
+// FNV-1a hash of a block of bytes
+inline uint64_t checkpoint_checksum(const char* data, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// Serializes an optimizer's state into a checkpoint file
+class CheckpointWriter {
+public:
+    explicit CheckpointWriter(const std::string& kind) {
+        bytes.append(checkpoint_magic, sizeof(checkpoint_magic) - 1);
+        write(checkpoint_version);
+        write(checkpoint_byte_order);
+        write(kind);
+    }
+
+    // Write a number, a string, or a vector or pair of those
+    template <typename V>
+    void write(const V& value) {
+        if constexpr (std::is_arithmetic<V>::value || std::is_enum<V>::value) {
+            bytes.append(reinterpret_cast<const char*>(&value), sizeof(V));
+        } else if constexpr (std::is_same<V, std::string>::value) {
+            write(static_cast<uint64_t>(value.size()));
+            bytes.append(value);
+        } else {
+            write_compound(value);
+        }
+    }
+
+    // Write the state of a standard random number engine or distribution, so reading it back continues the same sequence
+    template <typename Engine>
+    void write_random(const Engine& engine) {
+        std::ostringstream text;
+        text << engine;
+        write(text.str());
+    }
+
+    // Write the checkpoint to path atomically - it is written next to path, flushed to disk, and renamed over path,
+    // so a crash leaves either the previous checkpoint or the new one, never a partial file
+    void commit(const std::string& path) const {
+        std::string file = bytes;
+        uint64_t checksum = checkpoint_checksum(file.data(), file.size());
+        file.append(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+
+        std::string temporary = path + ".tmp"; // File the checkpoint is written to before it replaces path
+        std::FILE* out = std::fopen(temporary.c_str(), "wb");
+        if (out == nullptr) { // If the file cannot be created...
+            throw std::runtime_error("Cannot write checkpoint \"" + temporary + "\"!"); // Throw an exception
+        }
+        bool written = std::fwrite(file.data(), 1, file.size(), out) == file.size() && std::fflush(out) == 0;
+#if defined(__unix__) || defined(__APPLE__)
+        written = written && fsync(fileno(out)) == 0; // Make sure the contents reach the disk before the rename does
+#endif
+        written = std::fclose(out) == 0 && written;
+        if (!written || std::rename(temporary.c_str(), path.c_str()) != 0) { // If the checkpoint could not be written or moved into place...
+            std::remove(temporary.c_str());
+            throw std::runtime_error("Cannot write checkpoint \"" + path + "\"!"); // Throw an exception
+        }
+    }
+
+private:
+    template <typename V>
+    void write_compound(const std::vector<V>& values) {
+        write(static_cast<uint64_t>(values.size()));
+        if constexpr (std::is_arithmetic<V>::value) {
+            bytes.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(V));
+        } else {
+            for (const V& value : values) {
+                write(value);
+            }
+        }
+    }
+
+    template <typename A, typename B>
+    void write_compound(const std::pair<A, B>& value) {
+        write(value.first);
+        write(value.second);
+    }
+
+    std::string bytes; // Contents of the checkpoint so far
+};
+
+// Restores an optimizer's state from a checkpoint file, checking that the file is intact and holds the expected kind of state
+class CheckpointReader {
+public:
+    CheckpointReader(const std::string& path, const std::string& kind) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) { // If the file cannot be opened...
+            throw std::runtime_error("Cannot read checkpoint \"" + path + "\"!"); // Throw an exception
+        }
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+        uint64_t checksum;
+        size_t header = sizeof(checkpoint_magic) - 1;
+        if (bytes.size() < header + sizeof(checksum) || bytes.compare(0, header, checkpoint_magic) != 0) { // If it is not a checkpoint...
+            throw std::runtime_error("\"" + path + "\" is not a checkpoint!"); // Throw an exception
+        }
+        end = bytes.size() - sizeof(checksum);
+        std::memcpy(&checksum, bytes.data() + end, sizeof(checksum));
+        if (checksum != checkpoint_checksum(bytes.data(), end)) { // If it was damaged...
+            throw std::runtime_error("Checkpoint \"" + path + "\" is corrupt!"); // Throw an exception
+        }
+        at = header;
+        if (read<uint32_t>() != checkpoint_version || read<uint32_t>() != checkpoint_byte_order) { // If it was written by another version or on another machine...
+            throw std::runtime_error("Checkpoint \"" + path + "\" was written by an incompatible version or machine!"); // Throw an exception
+        }
+        if (read<std::string>() != kind) { // If it holds the state of another optimizer...
+            throw std::runtime_error("Checkpoint \"" + path + "\" does not hold the state of " + kind + "!"); // Throw an exception
+        }
+    }
+
+    // Read a value written by CheckpointWriter::write
+    template <typename V>
+    V read() {
+        V value;
+        read(value);
+        return value;
+    }
+
+    template <typename V>
+    void read(V& value) {
+        if constexpr (std::is_arithmetic<V>::value || std::is_enum<V>::value) {
+            std::memcpy(&value, take(sizeof(V)), sizeof(V));
+        } else if constexpr (std::is_same<V, std::string>::value) {
+            size_t size = read<uint64_t>();
+            value.assign(take(size), size);
+        } else {
+            read_compound(value);
+        }
+    }
+
+    // Read the state of a random number engine or distribution written by CheckpointWriter::write_random
+    template <typename Engine>
+    void read_random(Engine& engine) {
+        std::istringstream text(read<std::string>());
+        text >> engine;
+        if (!text) { // If the state could not be parsed...
+            throw std::runtime_error("Checkpoint holds an invalid random number generator state!"); // Throw an exception
+        }
+    }
+
+    // Check that a restored value matches the run resuming from the checkpoint
+    template <typename V>
+    static void expect(const V& saved, const V& actual, const char* what) {
+        if (saved != actual) {
+            throw std::invalid_argument(std::string("Checkpoint does not match the run - the ") + what + " differs!"); // Throw an exception
+        }
+    }
+
+private:
+    // Pointer to the next size bytes, which are then consumed
+    const char* take(size_t size) {
+        if (size > end - at) { // If the file ends first...
+            throw std::runtime_error("Checkpoint is truncated!"); // Throw an exception
+        }
+        const char* data = bytes.data() + at;
+        at += size;
+        return data;
+    }
+
+    template <typename V>
+    void read_compound(std::vector<V>& values) {
+        size_t size = read<uint64_t>();
+        if constexpr (std::is_arithmetic<V>::value) {
+            if (size > (end - at) / sizeof(V)) { // If the file ends first...
+                throw std::runtime_error("Checkpoint is truncated!"); // Throw an exception
+            }
+            values.resize(size);
+            std::memcpy(values.data(), take(size * sizeof(V)), size * sizeof(V));
+        } else {
+            values.clear();
+            for (size_t i = 0; i < size; ++i) {
+                values.push_back(read<V>());
+            }
+        }
+    }
+
+    template <typename A, typename B>
+    void read_compound(std::pair<A, B>& value) {
+        read(value.first);
+        read(value.second);
+    }
+
+    std::string bytes; // Contents of the file
+    size_t at = 0; // Offset of the next value
+    size_t end = 0; // Offset of the checksum
+};
+
+} // namespace quickopt
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace quickopt {
+
+// Bounded cache of objective values keyed by parameter vector - evicts with the CLOCK algorithm once its memory estimate exceeds the cap
+// Safe to share between threads; a cap of 0 disables the cache, so every lookup misses and nothing is stored
+template <typename T>
+class EvalCache {
+public:
+    explicit EvalCache(size_t max_bytes) : max_bytes(max_bytes) {}
+
+    bool enabled() const { return max_bytes > 0; } // Whether the cache stores anything
+
+    // Look up the value of a set of parameters, counting a hit or a miss
+    bool lookup(const T* params, size_t n, double& value) {
+        if (!enabled()) { // If the cache is disabled...
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        key.assign(params, params + n);
+        auto it = index.find(key);
+        if (it == index.end()) { // If the parameters have not been seen...
+            ++miss_count;
+            return false;
+        }
+        ++hit_count;
+        Slot& slot = slots[it->second];
+        slot.referenced = true; // Give the entry a second chance at the next sweep
+        value = slot.value;
+        return true;
+    }
+
+    // Store the value of a set of parameters, evicting entries until it fits under the cap
+    void insert(const T* params, size_t n, double value) {
+        if (!enabled()) { // If the cache is disabled...
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        key.assign(params, params + n);
+        if (index.count(key) != 0) { // If the parameters are already stored...
+            return;
+        }
+        size_t size = entry_bytes(key); // Estimated memory of the new entry
+        if (size > max_bytes) { // If it could never fit...
+            return;
+        }
+        while (bytes + size > max_bytes) { // While the entry does not fit...
+            evict(); // Free the next entry the clock hand finds unreferenced
+        }
+
+        size_t s; // Slot of the new entry
+        if (!free_slots.empty()) { // If an evicted slot can be reused...
+            s = free_slots.back();
+            free_slots.pop_back();
+        } else { // If not...
+            s = slots.size();
+            slots.emplace_back();
+        }
+        auto inserted = index.emplace(key, s).first;
+        slots[s] = Slot{&inserted->first, value, size, false, true};
+        bytes += size;
+    }
+
+    size_t hits() const { return hit_count; } // Number of lookups that found a value
+    size_t misses() const { return miss_count; } // Number of lookups that found nothing
+    size_t size() const { return index.size(); } // Number of stored entries
+
+private:
+    // Entry of the clock
+    struct Slot {
+        const std::vector<T>* key = nullptr; // Parameters of the entry, owned by the index
+        double value = 0; // Value of the parameters
+        size_t bytes = 0; // Estimated memory of the entry
+        bool referenced = false; // Whether the entry was looked up since the hand last passed it
+        bool used = false; // Whether the slot holds an entry
+    };
+
+    // Hash of a parameter vector - combines the hash of every parameter
+    struct KeyHash {
+        size_t operator()(const std::vector<T>& params) const {
+            size_t h = params.size();
+            for (const T& p : params) {
+                h ^= std::hash<T>()(p) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+            }
+            return h;
+        }
+    };
+
+    // Estimated memory of an entry - its parameters, plus the index node and slot overhead
+    static size_t entry_bytes(const std::vector<T>& params) {
+        size_t size = sizeof(Slot) + sizeof(std::vector<T>) + 4 * sizeof(void*) + params.size() * sizeof(T);
+        if constexpr (std::is_same<T, std::string>::value) { // Strings also own their characters
+            for (const std::string& p : params) {
+                size += p.capacity();
+            }
+        }
+        return size;
+    }
+
+    // Advance the clock hand to the first unreferenced entry, clearing references on the way, and evict it
+    void evict() {
+        while (true) {
+            if (hand >= slots.size()) {
+                hand = 0;
+            }
+            Slot& slot = slots[hand++];
+            if (!slot.used) { // If the slot is free...
+                continue;
+            }
+            if (slot.referenced) { // If the entry was used recently...
+                slot.referenced = false; // Clear its reference and move on
+                continue;
+            }
+            bytes -= slot.bytes;
+            index.erase(*slot.key); // Remove the entry
+            slot = Slot();
+            free_slots.push_back(hand - 1);
+            return;
+        }
+    }
+
+    size_t max_bytes; // Memory cap
+    size_t bytes = 0; // Estimated memory of every entry
+    std::unordered_map<std::vector<T>, size_t, KeyHash> index; // Slot of each stored parameter vector
+    std::vector<Slot> slots; // Clock of entries
+    std::vector<size_t> free_slots; // Slots freed by eviction
+    size_t hand = 0; // Clock hand
+    std::vector<T> key; // Scratch key used for lookups
+    size_t hit_count = 0; // Number of lookups that found a value
+    size_t miss_count = 0; // Number of lookups that found nothing
+    std::mutex mutex; // Guards the cache when it is shared between threads
+};
+
+} // namespace quickopt
@@ -0,0 +1,630 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "alphabet.hpp"
+#include "checkpoint.hpp"
+#include "eval_cache.hpp"
+#include "random.hpp"
+#include "stats.hpp"
+#include "termination.hpp"
+#include "thread_pool.hpp"
+
+namespace quickopt {
+
+// Crossover and mutation operators of a genetic algorithm - built-in operators run without leaving C++, and the mutation may instead be a custom function
+// Crossover: single_point, k_point (k), uniform (swap_p), and for doubles blend (alpha) and sbx (crossover_eta), both optionally clamped to [crossover_low, crossover_high]
+// Mutation: gaussian (sigma) for numbers, polynomial (mutation_eta) for doubles, bit_flip (bits) for integers, swap for any type and char_substitution (alphabet) for strings,
+// the numeric ones optionally clamped to [mutation_low, mutation_high]; each but swap changes every gene with probability gene_rate
+template <typename T>
+class GeneticOperators {
+public:
+    enum class Crossover { single_point, k_point, uniform, blend, sbx }; // Built-in crossover operators
+    enum class Mutation { custom, gaussian, polynomial, bit_flip, swap, char_substitution }; // Built-in mutation operators, or a custom function
+
+    // Cross a father and mother over into a child's row
+    void crossover(const T* father, const T* mother, T* child, size_t dim, std::mt19937& rng) const {
+        switch (crossover_op) {
+        case Crossover::single_point: { // Take the parameters before a random split from the father, and the rest from the mother
+            size_t split = std::uniform_int_distribution<size_t>(0, dim - 1)(rng); // Randomly select a split point for the crossover
+            std::copy(father, father + split, child);
+            std::copy(mother + split, mother + dim, child + split);
+            break;
+        }
+        case Crossover::k_point: { // Alternate between the parents at k random cut points
+            std::uniform_int_distribution<size_t> cut(1, std::max<size_t>(dim, 2) - 1);
+            size_t cuts[64]; // Cut points, sorted
+            size_t n_cuts = static_cast<size_t>(k);
+            for (size_t c = 0; c < n_cuts; ++c) {
+                cuts[c] = cut(rng);
+            }
+            std::sort(cuts, cuts + n_cuts);
+            size_t start = 0;
+            bool from_father = true;
+            for (size_t c = 0; c <= n_cuts; ++c) { // For each segment between cuts...
+                size_t end = c < n_cuts ? std::min(cuts[c], dim) : dim;
+                const T* parent = from_father ? father : mother;
+                std::copy(parent + start, parent + std::max(start, end), child + start);
+                start = std::max(start, end);
+                from_father = !from_father;
+            }
+            break;
+        }
+        case Crossover::uniform: { // Take each parameter from either parent at random
+            std::bernoulli_distribution from_mother(swap_p);
+            for (size_t j = 0; j < dim; ++j) {
+                child[j] = from_mother(rng) ? mother[j] : father[j];
+            }
+            break;
+        }
+        case Crossover::blend:
+        case Crossover::sbx:
+            if constexpr (std::is_same<T, double>::value) {
+                std::uniform_real_distribution<double> unit(0.0, 1.0);
+                for (size_t j = 0; j < dim; ++j) { // For each parameter...
+                    double value;
+                    if (crossover_op == Crossover::blend) { // BLX-alpha - uniform over the parents' range, extended by alpha of it on each side
+                        double lo = std::min(father[j], mother[j]), hi = std::max(father[j], mother[j]);
+                        double extent = alpha * (hi - lo);
+                        value = lo - extent + unit(rng) * (hi - lo + 2 * extent);
+                    } else { // Simulated binary crossover - spreads the child around the parents like single-point crossover spreads bit strings
+                        double u = unit(rng);
+                        double beta = u <= 0.5 ? std::pow(2 * u, 1 / (crossover_eta + 1)) : std::pow(1 / (2 * (1 - u)), 1 / (crossover_eta + 1));
+                        double sign = unit(rng) < 0.5 ? 1.0 : -1.0; // Pick one of the two children at random
+                        value = 0.5 * ((father[j] + mother[j]) + sign * beta * (father[j] - mother[j]));
+                    }
+                    child[j] = crossover_bounded ? std::min(std::max(value, crossover_low), crossover_high) : value;
+                }
+            }
+            break;
+        }
+    }
+
+    // Mutate a child's row in place - scratch is used to pass the child to a custom mutation function
+    void mutate(T* child, size_t dim, std::mt19937& rng, std::vector<T>& scratch) const {
+        if (mutation_op == Mutation::custom) { // If the mutation is a custom function...
+            std::copy(child, child + dim, scratch.begin());
+            std::vector<T> mutated = custom_mutate(scratch); // Mutate the child's parameters
+            if (mutated.size() != dim) { // If the mutation changed the number of parameters...
+                throw std::invalid_argument("Mutation must not change the number of parameters!"); // Throw an exception
+            }
+            std::copy(mutated.begin(), mutated.end(), child);
+            return;
+        }
+        if (dim == 0) { // If there is nothing to mutate...
+            return;
+        }
+        if (mutation_op == Mutation::swap) { // If the mutation swaps two genes...
+            std::uniform_int_distribution<size_t> gene(0, dim - 1);
+            std::swap(child[gene(rng)], child[gene(rng)]); // Swap two random genes
+            return;
+        }
+
+        // Mutate each gene with probability gene_rate, and at least one gene
+        double rate = gene_rate < 0 ? 1.0 / dim : gene_rate; // Probability of changing each gene
+        std::bernoulli_distribution chosen(std::min(rate, 1.0));
+        bool changed = false; // Whether a gene has been changed
+        for (size_t j = 0; j < dim; ++j) { // For each gene...
+            if (chosen(rng)) {
+                mutate_gene(child[j], rng);
+                changed = true;
+            }
+        }
+        if (!changed) { // If no gene was chosen...
+            mutate_gene(child[std::uniform_int_distribution<size_t>(0, dim - 1)(rng)], rng); // Change a random one
+        }
+    }
+
+    Crossover crossover_op = Crossover::single_point; // Selected crossover
+    int k = 2; // Number of cut points for k-point crossover
+    double swap_p = 0.5; // Probability of taking each gene from the mother in uniform crossover
+    double alpha = 0.5; // Range extension of blend crossover
+    double crossover_eta = 15.0; // Distribution index of simulated binary crossover
+    bool crossover_bounded = false; // Whether blend and simulated binary crossover clamp to [crossover_low, crossover_high]
+    double crossover_low = 0, crossover_high = 0; // Bounds of blend and simulated binary crossover
+
+    Mutation mutation_op = Mutation::custom; // Selected mutation
+    std::function<std::vector<T>(const std::vector<T>&)> custom_mutate; // Custom mutation function - takes in a set of parameters and returns a mutated set of parameters
+    double gene_rate = -1.0; // Probability of changing each gene - negative for 1 / dim
+    double sigma = 0.1; // Standard deviation of Gaussian mutation
+    double mutation_eta = 20.0; // Distribution index of polynomial mutation
+    bool mutation_bounded = false; // Whether Gaussian and polynomial mutation clamp to [mutation_low, mutation_high]
+    double mutation_low = 0, mutation_high = 0; // Bounds of Gaussian and polynomial mutation
+    int bits = 1; // Number of low bits bit-flip mutation may flip
+    std::string alphabet = printable_ascii(); // Characters character substitution may substitute in
+
+private:
+    // Mutate a single gene
+    void mutate_gene(T& gene, std::mt19937& rng) const {
+        if constexpr (std::is_arithmetic<T>::value) {
+            if (mutation_op == Mutation::gaussian) { // Add Gaussian noise
+                double value = static_cast<double>(gene) + std::normal_distribution<double>(0.0, sigma)(rng);
+                if (mutation_bounded) { // Keep it within the bounds
+                    value = std::min(std::max(value, mutation_low), mutation_high);
+                }
+                gene = std::is_integral<T>::value ? static_cast<T>(std::lround(value)) : static_cast<T>(value);
+            } else if (mutation_op == Mutation::polynomial) { // Polynomial mutation (Deb) - a bounded change, denser near the current value
+                double x = static_cast<double>(gene);
+                double range = mutation_high - mutation_low;
+                double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+                double power = 1 / (mutation_eta + 1);
+                double delta;
+                if (u < 0.5) {
+                    double xy = 1 - (x - mutation_low) / range;
+                    delta = std::pow(2 * u + (1 - 2 * u) * std::pow(xy, mutation_eta + 1), power) - 1;
+                } else {
+                    double xy = 1 - (mutation_high - x) / range;
+                    delta = 1 - std::pow(2 * (1 - u) + 2 * (u - 0.5) * std::pow(xy, mutation_eta + 1), power);
+                }
+                gene = static_cast<T>(std::min(std::max(x + delta * range, mutation_low), mutation_high));
+            } else if constexpr (std::is_integral<T>::value) {
+                if (mutation_op == Mutation::bit_flip) { // Flip one of the low bits
+                    gene ^= static_cast<T>(1) << std::uniform_int_distribution<int>(0, bits - 1)(rng);
+                }
+            }
+        } else if constexpr (std::is_same<T, std::string>::value) {
+            if (mutation_op == Mutation::char_substitution && !gene.empty()) { // Substitute a random character
+                size_t at = std::uniform_int_distribution<size_t>(0, gene.size() - 1)(rng);
+                gene[at] = alphabet[std::uniform_int_distribution<size_t>(0, alphabet.size() - 1)(rng)];
+            }
+        }
+    }
+};
+
+// Population of a genetic algorithm - selects parents and survivors from the current population, and breeds the children that replace it
+// Genomes are stored in a contiguous arena, one row of dim parameters per individual, next to a second arena the next generation is bred into,
+// so turning over a generation is a buffer swap; only the parents and survivors are ordered, by partial selection
+template <typename T>
+class Population {
+public:
+    Population(const GeneticOperators<T>& operators, int population_size, int reproduction_ct, int survivor_ct, double mutation_rate, uint64_t seed)
+        : operators(operators), population_size(population_size), reproduction_ct(reproduction_ct), survivor_ct(survivor_ct), mutation_rate(mutation_rate),
+          rng(static_cast<std::mt19937::result_type>(seed)), dist(0, population_size - 1) {
+        if (reproduction_ct > population_size) { // Check if reproduction count is greater than population size...
+            throw std::invalid_argument("reproduction_ct cannot be greater than population_size"); // If so, throw an exception
+        }
+        if (survivor_ct > population_size) { // Check if survivor count is greater than population size...
+            throw std::invalid_argument("survivor_ct cannot be greater than population_size"); // If so, throw an exception
+        }
+    }
+
+    // Fill the population with unevaluated genomes - every genome must have the same number of parameters
+    void init(const std::vector<std::vector<T>>& params) {
+        n = params.size(); // Number of individuals
+        dim = params.empty() ? 0 : params[0].size(); // Number of parameters per individual
+        genes.resize(n * dim); // Size both arenas once
+        next_genes.resize(n * dim);
+        fitness_values.assign(n, std::numeric_limits<double>::lowest()); // No individual has been evaluated yet
+        next_fitness.resize(n);
+        order.resize(n);
+        std::iota(order.begin(), order.end(), 0); // Start with every individual in order
+        scratch.resize(dim);
+        for (size_t i = 0; i < n; ++i) { // For each individual...
+            if (params[i].size() != dim) { // If it is not the size of the rest...
+                throw std::invalid_argument("Every set of parameters must have the same size!"); // Throw an exception
+            }
+            std::copy(params[i].begin(), params[i].end(), genes.begin() + i * dim); // Copy it into its row
+        }
+    }
+
+    size_t size() const { return n; } // Number of individuals
+    size_t dimension() const { return dim; } // Number of parameters per individual
+    const T* genome(size_t i) const { return &genes[i * dim]; } // Parameters of an individual
+    double* fitness() { return fitness_values.data(); } // Fitness of every individual, written by the caller after evaluating
+    double fitness_of(size_t i) const { return fitness_values[i]; } // Fitness of an individual
+    std::vector<T> params(size_t i) const { return std::vector<T>(genome(i), genome(i) + dim); } // Copy of the parameters of an individual
+
+    // Index of the fittest individual
+    size_t best() const {
+        return static_cast<size_t>(std::max_element(fitness_values.begin(), fitness_values.end()) - fitness_values.begin());
+    }
+
+    // Average fitness of the population
+    double mean_fitness() const {
+        return std::accumulate(fitness_values.begin(), fitness_values.end(), 0.0) / n;
+    }
+
+    double spread() const { return parameter_spread(genes.data(), n, dim); } // Mean standard deviation of the individuals' parameters - NaN unless they are numeric
+
+    // Partially order the population so the first reproduction_ct and survivor_ct entries of the order are the fittest, without sorting the rest
+    void select() {
+        auto fitter = [this](size_t a, size_t b) { return fitness_values[a] > fitness_values[b]; }; // Compare two individuals based on fitness value
+        size_t parents = std::min(static_cast<size_t>(reproduction_ct), n); // Number of parents
+        size_t survivors = std::min(static_cast<size_t>(survivor_ct), n); // Number of survivors
+        size_t outer = std::max(parents, survivors), inner = std::min(parents, survivors);
+        std::nth_element(order.begin(), order.begin() + outer, order.end(), fitter); // Move the fittest outer individuals to the front
+        std::nth_element(order.begin(), order.begin() + inner, order.begin() + outer, fitter); // And the fittest inner of those to the very front
+    }
+
+    // Breed the next generation into the back arena from the selected parents, then swap it in - the population must be selected
+    // The survivors keep their fitness, and the children fill rows [first_child(), size()) and are waiting to be evaluated
+    // Crossover and mutation are timed into stats, unless it is null
+    void breed(Stats* stats = nullptr) {
+        size_t survivors = first_child(); // Number of survivors
+        for (size_t i = 0; i < survivors; ++i) { // For each survivor...
+            std::copy(genes.begin() + order[i] * dim, genes.begin() + (order[i] + 1) * dim, next_genes.begin() + i * dim); // Copy it into the next generation
+            next_fitness[i] = fitness_values[order[i]]; // Keep its fitness value
+        }
+        for (size_t i = survivors; i < n; ++i) { // For each child...
+            size_t father_idx = order[dist(rng) % reproduction_ct]; // Randomly select a father from the parents
+            size_t mother_idx = order[dist(rng) % reproduction_ct]; // Randomly select a mother from the parents
+            T* child = &next_genes[i * dim]; // Row the child is bred into
+            {
+                PhaseTimer timer(stats, Phase::crossover);
+                operators.crossover(genome(father_idx), genome(mother_idx), child, dim, rng); // Cross the parents over into the child
+            }
+            if (std::uniform_real_distribution<>(0.0, 1.0)(rng) < mutation_rate) { // If the random number is less than the mutation rate...
+                PhaseTimer timer(stats, Phase::mutation);
+                operators.mutate(child, dim, rng, scratch); // Mutate the child's parameters
+            }
+            next_fitness[i] = std::numeric_limits<double>::lowest(); // The child has not been evaluated yet
+        }
+        genes.swap(next_genes); // Turn over the generation
+        fitness_values.swap(next_fitness);
+        std::iota(order.begin(), order.end(), 0);
+    }
+
+    size_t first_child() const { return std::min(static_cast<size_t>(survivor_ct), n); } // Row of the first child after breed()
+
+    // Swap two individuals' rows, with their fitness values
+    void swap(size_t i, size_t j) {
+        if (i != j) {
+            std::swap_ranges(genes.begin() + i * dim, genes.begin() + (i + 1) * dim, genes.begin() + j * dim);
+            std::swap(fitness_values[i], fitness_values[j]);
+        }
+    }
+
+    // Append copies of the count fittest individuals to genomes and fitness, fittest first
+    void emigrants(size_t count, std::vector<T>& genomes, std::vector<double>& fitness) const {
+        count = std::min(count, n);
+        std::vector<size_t> fittest(n);
+        std::iota(fittest.begin(), fittest.end(), 0);
+        std::partial_sort(fittest.begin(), fittest.begin() + count, fittest.end(), [this](size_t a, size_t b) { return fitness_values[a] > fitness_values[b]; });
+        for (size_t i = 0; i < count; ++i) { // For each emigrant...
+            genomes.insert(genomes.end(), genome(fittest[i]), genome(fittest[i]) + dim); // Copy its parameters
+            fitness.push_back(fitness_values[fittest[i]]); // And its fitness value
+        }
+    }
+
+    // Replace the least fit individuals with evaluated immigrants, given as rows of dim parameters - the fittest immigrants are kept if there are more than individuals
+    void immigrate(const std::vector<T>& genomes, const std::vector<double>& fitness) {
+        std::vector<size_t> arrivals(fitness.size());
+        std::iota(arrivals.begin(), arrivals.end(), 0);
+        size_t count = std::min(arrivals.size(), n); // Number of immigrants that settle
+        std::partial_sort(arrivals.begin(), arrivals.begin() + count, arrivals.end(), [&fitness](size_t a, size_t b) { return fitness[a] > fitness[b]; });
+        std::vector<size_t> weakest(n);
+        std::iota(weakest.begin(), weakest.end(), 0);
+        std::nth_element(weakest.begin(), weakest.begin() + count, weakest.end(), [this](size_t a, size_t b) { return fitness_values[a] < fitness_values[b]; });
+        for (size_t i = 0; i < count; ++i) { // For each settling immigrant...
+            std::copy(genomes.begin() + arrivals[i] * dim, genomes.begin() + (arrivals[i] + 1) * dim, genes.begin() + weakest[i] * dim); // Replace one of the weakest individuals
+            fitness_values[weakest[i]] = fitness[arrivals[i]];
+        }
+    }
+
+    // Write the genomes, their fitness and the random number generator to a checkpoint
+    void save(CheckpointWriter& out) const {
+        out.write(static_cast<uint64_t>(n));
+        out.write(static_cast<uint64_t>(dim));
+        out.write(genes);
+        out.write(fitness_values);
+        out.write(std::vector<uint64_t>(order.begin(), order.end()));
+        out.write_random(rng);
+    }
+
+    // Restore a state written by save(), in place of init()
+    void load(CheckpointReader& in) {
+        size_t saved_n = in.read<uint64_t>(); // Number of individuals
+        size_t saved_dim = in.read<uint64_t>(); // Number of parameters per individual
+        CheckpointReader::expect<size_t>(saved_n, static_cast<size_t>(std::max(population_size, 0)), "population size");
+        init(std::vector<std::vector<T>>(saved_n, std::vector<T>(saved_dim))); // Size the arenas
+        in.read(genes);
+        in.read(fitness_values);
+        std::vector<uint64_t> saved_order = in.read<std::vector<uint64_t>>();
+        in.read_random(rng);
+        if (genes.size() != n * dim || fitness_values.size() != n || saved_order.size() != n) { // If the arrays do not fit the population...
+            throw std::runtime_error("Checkpoint holds an inconsistent population!"); // Throw an exception
+        }
+        for (size_t i = 0; i < n; ++i) { // For each entry of the order...
+            if (saved_order[i] >= n) { // If it is not an individual...
+                throw std::runtime_error("Checkpoint holds an inconsistent population!"); // Throw an exception
+            }
+            order[i] = saved_order[i];
+        }
+    }
+
+private:
+    GeneticOperators<T> operators; // Crossover and mutation operators
+    int population_size; // Population size
+    int reproduction_ct; // Number of individuals that will reproduce each generation
+    int survivor_ct; // Number of individuals that will survive each generation
+    double mutation_rate; // Mutation rate - the probability that a mutation will occur on a given individual
+
+    size_t n = 0; // Number of individuals
+    size_t dim = 0; // Number of parameters per individual
+    std::vector<T> genes; // Genomes of the current generation, one row of dim parameters per individual
+    std::vector<T> next_genes; // Arena the next generation is bred into
+    std::vector<double> fitness_values; // Fitness of each individual in the current generation
+    std::vector<double> next_fitness; // Fitness of each individual in the next generation
+    std::vector<size_t> order; // Indices of the individuals, partially ordered by select()
+    std::vector<T> scratch; // Scratch vector used to pass a child to a custom mutation function
+
+    std::mt19937 rng; // Random number generator
+    std::uniform_int_distribution<> dist; // Uniform distribution for random integers
+};
+
+// Build the parameters of an initial population from the seed, generating the rest - generate() returns a new set of parameters
+template <typename T, typename Generate>
+std::vector<std::vector<T>> initial_population(Generate&& generate, const std::vector<std::vector<T>>& seed, int population_size) {
+    std::vector<std::vector<T>> params; // Parameters of the initial population
+    params.reserve(population_size); // Reserve space for the population based on population size
+    while (params.size() < static_cast<size_t>(population_size)) { // While the population is not full...
+        if (params.size() < seed.size()) { // If there are parameters within the seed...
+            params.push_back(seed[params.size()]); // Add those parameters to the population
+        } else {
+            params.push_back(generate()); // Generate random parameters and add them to the population
+        }
+    }
+    return params;
+}
+
+// Evaluate the fitness of the individuals in rows [begin, size()) of the population, skipping those found in the cache, if there is one
+// evaluate(genomes, n, dim, fitness) fills fitness[i] with the fitness of row i of the (n, dim) row-major genomes
+template <typename T, typename EvaluateRows>
+void evaluate_population(EvaluateRows& evaluate, Population<T>& population, size_t begin, EvalCache<T>* cache, Stats* stats = nullptr, Termination* termination = nullptr) {
+    if (cache != nullptr) { // If there is a cache...
+        for (size_t i = begin; i < population.size(); ++i) { // For each individual...
+            double value;
+            if (cache->lookup(population.genome(i), population.dimension(), value)) { // If its fitness is cached...
+                population.swap(i, begin); // Move it in front of the rows to evaluate
+                population.fitness()[begin++] = value; // Use the cached fitness
+            }
+        }
+    }
+    if (begin < population.size()) { // If there are individuals left to evaluate...
+        PhaseTimer timer(stats, Phase::objective);
+        evaluate(population.genome(begin), population.size() - begin, population.dimension(), population.fitness() + begin); // Calculate their fitness values
+        if (stats != nullptr) {
+            stats->count_evaluations(population.size() - begin);
+        }
+        if (termination != nullptr) {
+            termination->count_evaluations(population.size() - begin);
+        }
+    }
+    if (cache != nullptr) { // If there is a cache...
+        for (size_t i = begin; i < population.size(); ++i) { // For each new fitness value...
+            cache->insert(population.genome(i), population.dimension(), population.fitness_of(i)); // Store it
+        }
+    }
+}
+
+// Genetic algorithm evolving a single population - returns the parameters of the top individual in the final population
+template <typename T, typename EvaluateRows, typename Generate>
+std::vector<T> genetic(
+    EvaluateRows&& evaluate, // Evaluates rows of the population, to be *maximized* - called as evaluate(const T* genomes, size_t n, size_t dim, double* fitness)
+    Generate&& generate, // Generates a set of parameters to be used in the initial population (ideally randomly) - called as generate() and returns a std::vector<T>
+    const std::vector<std::vector<T>>& seed, // Seed population - a predefined set of parameters to be used in the initial population
+    const GeneticOperators<T>& operators, // Crossover and mutation operators
+    int population_size = 100, // Population size - more is better, but slower
+    int reproduction_ct = 10, // Number of individuals that will reproduce each generation - more leads to more diversity, but slower convergence
+    int survivor_ct = 0, // Number of individuals that will survive each generation - more leads to more stability, but could harm diversity
+    double mutation_rate = 0.1, // Mutation rate - the probability that a mutation will occur on a given individual
+    int generations = 100, // Number of generations to run the algorithm for
+    int verbose = 0, // Verbosity level - 1 outputs the average and top fitness each generation
+    EvalCache<T>* cache = nullptr, // Fitness cache, or null
+    Monitor* monitor = nullptr, // Collects stats and per-generation records, or null
+    const Checkpoint* checkpoint = nullptr, // Where the population is saved and resumed from, or null
+    Termination* termination = nullptr, // Budgets and convergence tests that may end the run early, and the reason it ended, or null
+    long long rng_seed = -1 // Seed for the random number generator - negative for a nondeterministic seed
+) {
+    Stats* stats = stats_of(monitor); // Per-phase timers, or null
+    if (termination != nullptr) {
+        termination->start(true); // Fitness is maximized
+        if (termination->measures_diversity() && !std::is_arithmetic<T>::value) { // If the spread of the population cannot be measured...
+            throw std::invalid_argument("Diversity threshold requires numeric parameters!"); // Throw an exception
+        }
+    }
+    Population<T> population(operators, population_size, reproduction_ct, survivor_ct, mutation_rate, mix_seed(run_seed(rng_seed))); // Population of individuals
+    int start = 0; // First generation to run
+    if (checkpoint != nullptr && checkpoint->resumable()) { // If the population was saved...
+        CheckpointReader in(checkpoint->path, "genetic");
+        start = in.read<int32_t>(); // Number of generations completed
+        population.load(in); // Restore the population
+    } else { // If not...
+        population.init(initial_population<T>(generate, seed, population_size)); // Populate the initial population
+        evaluate_population(evaluate, population, 0, cache, stats, termination); // Evaluate the initial population
+    }
+
+    for (int generation = start; generation < generations; ++generation) { // For each generation...
+        if (monitor != nullptr && monitor->recording()) { // If the records replace the output...
+            monitor->record(generation, population.fitness_of(population.best()), population.mean_fitness());
+        } else if (verbose == 1) { // If verbose is set to 1...
+            std::cout << "Generation " << generation // Output the generation number
+                      << ": Average Fitness: " << population.mean_fitness() // Output the average fitness
+                      << ", Top Fitness: " << population.fitness_of(population.best()) << std::endl; // Output the fitness of the top individual
+        }
+
+        {
+            PhaseTimer timer(stats, Phase::sort);
+            population.select(); // Select the parents and survivors
+        }
+        population.breed(stats); // Breed the next generation from the parents, keeping the survivors
+        evaluate_population(evaluate, population, population.first_child(), cache, stats, termination); // Evaluate the children
+
+        bool stopped = termination != nullptr && termination->stop(generation + 1, population.fitness_of(population.best()), termination->measures_diversity() ? population.spread() : 0.0); // Whether the run ends early
+        if (checkpoint != nullptr && (checkpoint->due(generation, generation + 1) || generation + 1 == generations || stopped)) { // If a save is due or the run has ended...
+            CheckpointWriter out("genetic");
+            out.write(static_cast<int32_t>(generation + 1));
+            population.save(out);
+            out.commit(checkpoint->path);
+        }
+        if (stopped) {
+            break;
+        }
+    }
+
+    if (monitor != nullptr) {
+        monitor->flush(); // Pass on the remaining records
+    }
+    return population.params(population.best()); // Return the parameters of the top individual in the final population
+}
+
+// Island-model genetic algorithm - islands evolve separate populations on their own threads, and every migration_interval generations
+// each sends copies of its fittest migrants to its neighbours, where they replace the least fit; ring sends to the next island, full to every other
+// evaluate is called from the island threads, with a Release guard held while the islands evolve, and must be thread-safe; generate is called on the calling thread
+template <typename Release = NoRelease, typename T, typename EvaluateRows, typename Generate>
+std::vector<T> genetic_islands(
+    EvaluateRows&& evaluate, // Evaluates rows of an island's population, to be *maximized* - called as evaluate(const T* genomes, size_t n, size_t dim, double* fitness)
+    Generate&& generate, // Generates a set of parameters to be used in the initial populations - called as generate() and returns a std::vector<T>
+    const std::vector<std::vector<T>>& seed, // Seed population - shared out between the islands in turn
+    const GeneticOperators<T>& operators, // Crossover and mutation operators
+    int population_size, int reproduction_ct, int survivor_ct, double mutation_rate, // Settings of each island's population
+    int generations, int verbose, // Number of generations and verbosity level
+    int islands, int migration_interval, int migrants, bool ring, // Island settings
+    EvalCache<T>* cache = nullptr, // Fitness cache shared by the islands, or null
+    Monitor* monitor = nullptr, // Collects stats and per-epoch records, or null
+    const Checkpoint* checkpoint = nullptr, // Where the islands are saved, after each epoch a save is due in, and resumed from, or null
+    Termination* termination = nullptr, // Budgets and convergence tests checked after each epoch, which may end the run early, and the reason it ended, or null
+    long long rng_seed = -1 // Seed the random number generator of every island is derived from - negative for nondeterministic seeds
+) {
+    Stats* stats = stats_of(monitor); // Per-phase timers, or null
+    if (termination != nullptr) {
+        termination->start(true); // Fitness is maximized
+        if (termination->measures_diversity() && !std::is_arithmetic<T>::value) { // If the spread of the populations cannot be measured...
+            throw std::invalid_argument("Diversity threshold requires numeric parameters!"); // Throw an exception
+        }
+    }
+    std::vector<std::unique_ptr<Population<T>>> populations; // Population of each island
+    uint64_t base_seed = run_seed(rng_seed); // Seed every island's random number stream is derived from
+    int start = 0; // First generation to run
+
+    if (checkpoint != nullptr && checkpoint->resumable()) { // If the islands were saved...
+        CheckpointReader in(checkpoint->path, "genetic_islands");
+        start = in.read<int32_t>(); // Number of generations completed
+        CheckpointReader::expect<int32_t>(in.read<int32_t>(), islands, "number of islands");
+        CheckpointReader::expect<int32_t>(in.read<int32_t>(), migration_interval, "migration interval");
+        for (int k = 0; k < islands; ++k) { // For each island...
+            populations.emplace_back(new Population<T>(operators, population_size, reproduction_ct, survivor_ct, mutation_rate, stream_seed(base_seed, k)));
+            populations.back()->load(in); // Restore its population
+        }
+    }
+    for (int k = static_cast<int>(populations.size()); k < islands; ++k) { // For each island left to populate...
+        std::vector<std::vector<T>> island_seed; // Seed individuals of the island
+        for (size_t s = k; s < seed.size(); s += islands) {
+            island_seed.push_back(seed[s]);
+        }
+        populations.emplace_back(new Population<T>(operators, population_size, reproduction_ct, survivor_ct, mutation_rate, stream_seed(base_seed, k))); // Give it its own population and random number generator
+        populations.back()->init(initial_population<T>(generate, island_seed, population_size)); // Populate it
+        if (populations.back()->dimension() != populations[0]->dimension()) { // If its individuals could not migrate to the first island...
+            throw std::invalid_argument("Every set of parameters must have the same size!"); // Throw an exception
+        }
+    }
+
+    ThreadPool pool(islands); // One thread per island
+    if (start == 0) { // If the islands were not restored...
+        Release release; // Let go of the caller's lock while the islands run in parallel
+        pool.parallel_for(islands, [&](size_t k, size_t) {
+            evaluate_population(evaluate, *populations[k], 0, cache, stats, termination); // Evaluate the island's initial population
+        });
+    }
+
+    for (int generation = start; generation < generations; generation += migration_interval) { // For each epoch between migrations...
+        bool recording = monitor != nullptr && monitor->recording(); // Whether the records replace the output
+        if (verbose == 1 || recording) {
+            double total_fitness = 0, top_fitness = std::numeric_limits<double>::lowest();
+            for (const auto& population : populations) { // For each island...
+                total_fitness += population->mean_fitness(); // Add its average fitness
+                top_fitness = std::max(top_fitness, population->fitness_of(population->best())); // And keep the top fitness
+            }
+            if (recording) {
+                monitor->record(generation, top_fitness, total_fitness / islands);
+            } else {
+                std::cout << "Generation " << generation // Output the generation number
+                          << ": Average Fitness: " << total_fitness / islands // Output the average fitness across islands
+                          << ", Top Fitness: " << top_fitness << std::endl; // Output the fitness of the top individual across islands
+            }
+        }
+
+        int epoch = std::min(migration_interval, generations - generation); // Number of generations until the next migration
+        {
+            Release release; // Let go of the caller's lock while the islands run in parallel
+            pool.parallel_for(islands, [&](size_t k, size_t) {
+                Population<T>& population = *populations[k];
+                for (int e = 0; e < epoch; ++e) { // For each generation of the epoch...
+                    {
+                        PhaseTimer timer(stats, Phase::sort);
+                        population.select(); // Select the parents and survivors
+                    }
+                    population.breed(stats); // Breed the next generation from the parents, keeping the survivors
+                    evaluate_population(evaluate, population, population.first_child(), cache, stats, termination); // Evaluate the children
+                }
+            });
+        }
+
+        if (generation + epoch < generations && migrants > 0) { // If the islands evolve further...
+            std::vector<std::vector<T>> genomes(islands); // Migrants arriving at each island
+            std::vector<std::vector<double>> values(islands); // Fitness of the migrants arriving at each island
+            for (int k = 0; k < islands; ++k) { // For each island...
+                for (int d = 1; d < islands; ++d) { // For each neighbour...
+                    int to = (k + d) % islands;
+                    populations[k]->emigrants(migrants, genomes[to], values[to]); // Send it copies of the fittest individuals
+                    if (ring) { // If the islands form a ring...
+                        break; // Only the next island is a neighbour
+                    }
+                }
+            }
+            for (int k = 0; k < islands; ++k) { // For each island...
+                populations[k]->immigrate(genomes[k], values[k]); // Settle the arriving migrants
+            }
+        }
+
+        bool stopped = false; // Whether the run ends early
+        if (termination != nullptr) {
+            double top_fitness = std::numeric_limits<double>::lowest(), spread = 0; // Top fitness and widest spread across islands
+            for (const auto& population : populations) { // For each island...
+                top_fitness = std::max(top_fitness, population->fitness_of(population->best()));
+                if (termination->measures_diversity()) {
+                    spread = std::max(spread, population->spread()); // The islands have collapsed only once every one has
+                }
+            }
+            stopped = termination->stop(generation + epoch, top_fitness, spread);
+        }
+        if (checkpoint != nullptr && (checkpoint->due(generation, generation + epoch) || generation + epoch == generations || stopped)) { // If a save is due or the run has ended...
+            CheckpointWriter out("genetic_islands");
+            out.write(static_cast<int32_t>(generation + epoch));
+            out.write(static_cast<int32_t>(islands));
+            out.write(static_cast<int32_t>(migration_interval));
+            for (const auto& population : populations) { // For each island...
+                population->save(out);
+            }
+            out.commit(checkpoint->path);
+        }
+        if (stopped) {
+            break;
+        }
+    }
+
+    if (monitor != nullptr) {
+        monitor->flush(); // Pass on the remaining records
+    }
+    size_t best_island = 0; // Island holding the top individual
+    for (int k = 1; k < islands; ++k) {
+        if (populations[k]->fitness_of(populations[k]->best()) > populations[best_island]->fitness_of(populations[best_island]->best())) {
+            best_island = k;
+        }
+    }
+    return populations[best_island]->params(populations[best_island]->best()); // Return the parameters of the top individual across islands
+}
+
+} // namespace quickopt
@@ -0,0 +1,468 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "checkpoint.hpp"
+#include "random.hpp"
+#include "stats.hpp"
+#include "termination.hpp"
+#include "thread_pool.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#endif
+
+namespace quickopt {
+
+// Velocity and position update kernel for a single particle - updates velocity and position in place
+// v = inertia * v + cognitive * r1 * (pb - x) + social * r2 * (gb - x), clamped to [-clamp, clamp], then x = x + v, clamped to [lo, hi]
+typedef void (*pso_kernel_t)(size_t dim, double inertia, double cognitive, double social, double clamp,
+                             const double* r1, const double* r2, const double* pb, const double* gb,
+                             const double* lo, const double* hi, double* pos, double* vel);
+
+// Scalar kernel - used as the fallback when no vector instructions are available, and for the tail of the vector kernels
+inline void pso_kernel_scalar(size_t dim, double inertia, double cognitive, double social, double clamp,
+                              const double* r1, const double* r2, const double* pb, const double* gb,
+                              const double* lo, const double* hi, double* pos, double* vel) {
+    for (size_t j = 0; j < dim; ++j) { // For every individual parameter in the function...
+        double proposed_velo_param = inertia * vel[j] + cognitive * r1[j] * (pb[j] - pos[j]) + social * r2[j] * (gb[j] - pos[j]); // Calculate the new velocity parameter based on the velocity formula
+        vel[j] = std::min(std::max(proposed_velo_param, -clamp), clamp); // Update the velocity using the clamping limit
+        double proposed_pos_param = pos[j] + vel[j]; // Calculate the new position parameter based on the velocity
+        pos[j] = std::min(std::max(proposed_pos_param, lo[j]), hi[j]); // Update the position using the search space limits
+    }
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define QUICKOPT_PSO_X86 1
+
+// AVX2 kernel - updates four parameters at a time
+__attribute__((target("avx2")))
+inline void pso_kernel_avx2(size_t dim, double inertia, double cognitive, double social, double clamp,
+                            const double* r1, const double* r2, const double* pb, const double* gb,
+                            const double* lo, const double* hi, double* pos, double* vel) {
+    const __m256d w = _mm256_set1_pd(inertia); // Broadcast the inertia weight
+    const __m256d c1 = _mm256_set1_pd(cognitive); // Broadcast the cognitive weight
+    const __m256d c2 = _mm256_set1_pd(social); // Broadcast the social weight
+    const __m256d vmax = _mm256_set1_pd(clamp); // Broadcast the upper velocity limit
+    const __m256d vmin = _mm256_set1_pd(-clamp); // Broadcast the lower velocity limit
+    size_t j = 0;
+    for (; j + 4 <= dim; j += 4) { // For every block of four parameters...
+        __m256d x = _mm256_loadu_pd(pos + j); // Load the positions
+        __m256d v = _mm256_mul_pd(w, _mm256_loadu_pd(vel + j)); // Inertia term
+        v = _mm256_add_pd(v, _mm256_mul_pd(_mm256_mul_pd(c1, _mm256_loadu_pd(r1 + j)), _mm256_sub_pd(_mm256_loadu_pd(pb + j), x))); // Cognitive term
+        v = _mm256_add_pd(v, _mm256_mul_pd(_mm256_mul_pd(c2, _mm256_loadu_pd(r2 + j)), _mm256_sub_pd(_mm256_loadu_pd(gb + j), x))); // Social term
+        v = _mm256_min_pd(_mm256_max_pd(v, vmin), vmax); // Clamp the velocity
+        x = _mm256_add_pd(x, v); // Move the particle
+        x = _mm256_min_pd(_mm256_max_pd(x, _mm256_loadu_pd(lo + j)), _mm256_loadu_pd(hi + j)); // Clamp the position to the search space
+        _mm256_storeu_pd(vel + j, v); // Store the velocities
+        _mm256_storeu_pd(pos + j, x); // Store the positions
+    }
+    pso_kernel_scalar(dim - j, inertia, cognitive, social, clamp, r1 + j, r2 + j, pb + j, gb + j, lo + j, hi + j, pos + j, vel + j); // Finish the remaining parameters
+}
+
+// AVX-512 kernel - updates eight parameters at a time
+// GCC 12 warns that the undefined vectors the AVX-512 intrinsics start from may be used uninitialized, which they are not
+#pragma GCC diagnostic push
+#if !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+__attribute__((target("avx512f")))
+inline void pso_kernel_avx512(size_t dim, double inertia, double cognitive, double social, double clamp,
+                              const double* r1, const double* r2, const double* pb, const double* gb,
+                              const double* lo, const double* hi, double* pos, double* vel) {
+    const __m512d w = _mm512_set1_pd(inertia); // Broadcast the inertia weight
+    const __m512d c1 = _mm512_set1_pd(cognitive); // Broadcast the cognitive weight
+    const __m512d c2 = _mm512_set1_pd(social); // Broadcast the social weight
+    const __m512d vmax = _mm512_set1_pd(clamp); // Broadcast the upper velocity limit
+    const __m512d vmin = _mm512_set1_pd(-clamp); // Broadcast the lower velocity limit
+    size_t j = 0;
+    for (; j + 8 <= dim; j += 8) { // For every block of eight parameters...
+        __m512d x = _mm512_loadu_pd(pos + j); // Load the positions
+        __m512d v = _mm512_mul_pd(w, _mm512_loadu_pd(vel + j)); // Inertia term
+        v = _mm512_add_pd(v, _mm512_mul_pd(_mm512_mul_pd(c1, _mm512_loadu_pd(r1 + j)), _mm512_sub_pd(_mm512_loadu_pd(pb + j), x))); // Cognitive term
+        v = _mm512_add_pd(v, _mm512_mul_pd(_mm512_mul_pd(c2, _mm512_loadu_pd(r2 + j)), _mm512_sub_pd(_mm512_loadu_pd(gb + j), x))); // Social term
+        v = _mm512_min_pd(_mm512_max_pd(v, vmin), vmax); // Clamp the velocity
+        x = _mm512_add_pd(x, v); // Move the particle
+        x = _mm512_min_pd(_mm512_max_pd(x, _mm512_loadu_pd(lo + j)), _mm512_loadu_pd(hi + j)); // Clamp the position to the search space
+        _mm512_storeu_pd(vel + j, v); // Store the velocities
+        _mm512_storeu_pd(pos + j, x); // Store the positions
+    }
+    pso_kernel_scalar(dim - j, inertia, cognitive, social, clamp, r1 + j, r2 + j, pb + j, gb + j, lo + j, hi + j, pos + j, vel + j); // Finish the remaining parameters
+}
+#pragma GCC diagnostic pop
+#endif
+
+// Select the widest kernel supported by the running CPU
+inline pso_kernel_t pso_select_kernel() {
+#ifdef QUICKOPT_PSO_X86
+    __builtin_cpu_init(); // Initialize the CPU feature detection
+    if (__builtin_cpu_supports("avx512f")) { // If the CPU supports AVX-512...
+        return pso_kernel_avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) { // If the CPU supports AVX2...
+        return pso_kernel_avx2;
+    }
+#endif
+    return pso_kernel_scalar; // Otherwise fall back to the scalar kernel
+}
+
+// Particle swarm - stores every particle's position, velocity and personal best, plus the global best - ONLY WORKS FOR DOUBLES!
+// Each matrix is contiguous and row-major, with one row of dim parameters per particle, and is updated in place
+template <typename T>
+class Swarm {
+public:
+    static_assert(std::is_same<T, double>::value, "pso only supports double parameters"); // The update kernels operate on doubles
+
+    Swarm(
+        const std::vector<T>& space_min, // Lower bound vector for the search space
+        const std::vector<T>& space_max, // Upper bound vector for the search space
+        int swarm_size, // Number of particles in the swarm
+        double inertia, // Inertia weight - recommended be in (0,1)
+        double cognitive, // Cognitive weight - recommended be in [1,3]
+        double social, // Social weight - recommended be in [1,3]
+        double clamp, // Clamping limit on velocity
+        uint64_t seed // Seed for the random number generator
+    ) : space_min(space_min), space_max(space_max), dim(space_min.size()), n(static_cast<size_t>(std::max(swarm_size, 0))),
+        inertia(inertia), cognitive(cognitive), social(social), clamp(clamp),
+        position(n * dim), velocity(n * dim), pb_pos(n * dim), value(n), pb_val(n, std::numeric_limits<double>::lowest()),
+        gb_pos(dim), gb_val(std::numeric_limits<double>::lowest()), r1(dim), r2(dim),
+        rng(static_cast<std::mt19937::result_type>(seed)), dist_space(0.0, 1.0), dist_velocity(-clamp, clamp), dist_inertia(0.0, 1.0) {
+
+        // Warn unusual inputs
+        if (inertia <= 0 || inertia >= 1) {  // If the inertia is outside the suggested limits...
+            std::cerr << "Inertia outside suggested limits! Recommended be in (0,1)" << std::endl; // Prints a warning message
+        }
+        if (cognitive < 1 || cognitive > 3) { // If the cognitive factor is outside the suggested limits...
+            std::cerr << "Cognition factor outside suggested limits! Recommended be in [1,3]" << std::endl; // Prints a warning message
+        }
+        if (social < 1 || social > 3) { // If the social factor is outside the suggested limits...
+            std::cerr << "Social factor outside suggested limits! Recommended be in [1,3]" << std::endl; // Prints a warning message
+        }
+
+        // Check for invalid inputs
+        if (space_min.size() != space_max.size()) { // If the space minimum and maximum vectors are not the same size...
+            throw std::invalid_argument("Search space vectors must be of same size!"); // Throw an exception
+        }
+
+        // Initialize the particles
+        for (size_t p = 0; p < n; ++p) { // For every proposed particle in swarm size...
+            for (size_t j = 0; j < dim; ++j) { // For every individual parameter in the function...
+                position[p * dim + j] = space_min[j] + dist_space(rng) * (space_max[j] - space_min[j]); // Generate a random position (input) parameter within the search space
+            }
+            for (size_t j = 0; j < dim; ++j) { // For every individual parameter in the function...
+                velocity[p * dim + j] = dist_velocity(rng); // Generate a random velocity parameter within the clamping limit
+            }
+        }
+        pb_pos = position; // The initial positions are the personal bests
+    }
+
+    size_t size() const { return n; } // Number of particles
+    size_t dimension() const { return dim; } // Number of parameters per particle
+    const T* positions() const { return position.data(); } // Positions of every particle
+    const T* position_of(size_t p) const { return &position[p * dim]; } // Position of a single particle
+    const std::vector<T>& best_position() const { return gb_pos; } // Global best position
+    double best_value() const { return gb_val; } // Global best value
+    double spread() const { return parameter_spread(position.data(), n, dim); } // Mean standard deviation of the particles' positions
+
+    // Move a particle by generating a new velocity, and then generating the particle's new position based off it
+    void move(size_t p) {
+        static const pso_kernel_t kernel = pso_select_kernel(); // Velocity and position update kernel, selected once at runtime
+
+        for (size_t j = 0; j < dim; ++j) { // For every individual parameter in the function...
+            r1[j] = dist_inertia(rng); // Generate a random factor r1
+            r2[j] = dist_inertia(rng); // Generate a random factor r2
+        }
+        kernel(dim, inertia, cognitive, social, clamp, r1.data(), r2.data(), &pb_pos[p * dim], gb_pos.data(),
+               space_min.data(), space_max.data(), &position[p * dim], &velocity[p * dim]); // Update the particle's velocity and position in place
+    }
+
+    // Record the value of a particle's current position, updating the personal and global bests
+    void update(size_t p, double new_value) {
+        value[p] = new_value; // Update the particle's value
+        if (new_value > pb_val[p]) { // If the new value is greater than the current personal best value...
+            std::copy(position.begin() + p * dim, position.begin() + (p + 1) * dim, pb_pos.begin() + p * dim); // Update the personal best position
+            pb_val[p] = new_value; // Update the personal best value
+            if (new_value > gb_val) { // If the new value is greater than the global best value...
+                gb_val = new_value; // Update the global best value
+                std::copy(position.begin() + p * dim, position.begin() + (p + 1) * dim, gb_pos.begin()); // Update the global best position
+            }
+        }
+    }
+
+    // Write the particles, the bests and the random number generator to a checkpoint
+    void save(CheckpointWriter& out) const {
+        out.write(static_cast<uint64_t>(n));
+        out.write(static_cast<uint64_t>(dim));
+        out.write(position);
+        out.write(velocity);
+        out.write(pb_pos);
+        out.write(value);
+        out.write(pb_val);
+        out.write(gb_pos);
+        out.write(gb_val);
+        out.write_random(rng);
+    }
+
+    // Restore a state written by save() - the swarm must have the same size and dimension
+    void load(CheckpointReader& in) {
+        CheckpointReader::expect<uint64_t>(in.read<uint64_t>(), n, "swarm size");
+        CheckpointReader::expect<uint64_t>(in.read<uint64_t>(), dim, "number of parameters");
+        in.read(position);
+        in.read(velocity);
+        in.read(pb_pos);
+        in.read(value);
+        in.read(pb_val);
+        in.read(gb_pos);
+        in.read(gb_val);
+        in.read_random(rng);
+        if (position.size() != n * dim || velocity.size() != n * dim || pb_pos.size() != n * dim || value.size() != n || pb_val.size() != n || gb_pos.size() != dim) { // If the arrays do not fit the swarm...
+            throw std::runtime_error("Checkpoint holds an inconsistent swarm!"); // Throw an exception
+        }
+    }
+
+private:
+    std::vector<T> space_min; // Lower bound vector for the search space
+    std::vector<T> space_max; // Upper bound vector for the search space
+    size_t dim; // Number of parameters in the function
+    size_t n; // Number of particles in the swarm
+    double inertia, cognitive, social, clamp; // Update weights and velocity clamp
+
+    std::vector<T> position; // Position of each particle
+    std::vector<T> velocity; // Velocity of each particle
+    std::vector<T> pb_pos; // Personal best position of each particle
+    std::vector<double> value; // Value of each particle
+    std::vector<double> pb_val; // Personal best value of each particle
+
+    std::vector<T> gb_pos; // Global best position
+    double gb_val; // Global best value
+
+    std::vector<double> r1; // Scratch vector of random factors r1 for a single particle
+    std::vector<double> r2; // Scratch vector of random factors r2 for a single particle
+
+    std::mt19937 rng; // Random number generator
+    std::uniform_real_distribution<> dist_space; // Uniform distribution for initial space
+    std::uniform_real_distribution<> dist_velocity; // Uniform distribution for initial velocity
+    std::uniform_real_distribution<> dist_inertia; // Uniform distribution for random factors
+};
+
+// Restore a swarm from a checkpoint if it asks to resume and a state was saved - returns the number of iterations the saved run completed, or 0
+template <typename T>
+int resume_swarm(const Checkpoint* checkpoint, Swarm<T>& swarm) {
+    if (checkpoint == nullptr || !checkpoint->resumable()) { // If there is nothing to resume from...
+        return 0;
+    }
+    CheckpointReader in(checkpoint->path, "pso");
+    int done = in.read<int32_t>(); // Number of iterations completed
+    swarm.load(in);
+    return done;
+}
+
+// Save a swarm after the iterations [before, after) if a save is due or the run has ended - a run that stops early passes after as its iterations
+template <typename T>
+void save_swarm(const Checkpoint* checkpoint, const Swarm<T>& swarm, int before, int after, int iterations) {
+    if (checkpoint == nullptr || (!checkpoint->due(before, after) && after < iterations)) { // If no save is due...
+        return;
+    }
+    CheckpointWriter out("pso");
+    out.write(static_cast<int32_t>(after));
+    swarm.save(out);
+    out.commit(checkpoint->path);
+}
+
+// Particle swarm optimization evaluating one particle at a time - each particle moves as soon as the previous one was evaluated, so it follows the latest global best
+// funct(params, n) returns the value of a particle's n parameters, to be *maximized*; returns the global best position
+template <typename T, typename Funct>
+std::vector<T> pso(
+    Funct&& funct, // The function to be *maximized* - called as funct(const T* params, size_t n)
+    const std::vector<T>& space_min, // Lower bound vector for the search space
+    const std::vector<T>& space_max, // Upper bound vector for the search space
+    int iterations = 100, // Number of iterations to run the algorithm for
+    int swarm_size = 100, // Number of particles in the swarm
+    double inertia = 0.5, // Inertia weight - recommended be in (0,1)
+    double cognitive = 1.0, // Cognitive weight - recommended be in [1,3]
+    double social = 2.0, // Social weight - recommended be in [1,3]
+    double clamp = 0.1, // Clamping limit on velocity
+    int verbose = 0, // Verbosity level - -1 for no output, 0 for final output, 1 for output at each iteration
+    Monitor* monitor = nullptr, // Collects stats and per-iteration records, or null
+    const Checkpoint* checkpoint = nullptr, // Where the swarm is saved and resumed from, or null
+    Termination* termination = nullptr, // Budgets and convergence tests that may end the run early, and the reason it ended, or null
+    long long rng_seed = -1 // Seed for the random number generator - negative for a nondeterministic seed
+) {
+    Swarm<T> swarm(space_min, space_max, swarm_size, inertia, cognitive, social, clamp, mix_seed(run_seed(rng_seed))); // Initialize the swarm
+    size_t n = swarm.size(); // Number of particles in the swarm
+    size_t dim = swarm.dimension(); // Number of parameters in the function
+    Stats* stats = stats_of(monitor); // Per-phase timers, or null
+    int start = resume_swarm(checkpoint, swarm); // First iteration to run
+    if (termination != nullptr) {
+        termination->start(true); // The swarm maximizes
+    }
+
+    // Calculate the value of a particle and update its bests
+    auto evaluate = [&](size_t p) {
+        double value;
+        {
+            PhaseTimer timer(stats, Phase::objective);
+            value = funct(swarm.position_of(p), dim);
+        }
+        if (stats != nullptr) {
+            stats->count_evaluations(1);
+        }
+        if (termination != nullptr) {
+            termination->count_evaluations(1);
+        }
+        swarm.update(p, value);
+    };
+
+    if (start == 0) { // If the swarm was not restored...
+        for (size_t p = 0; p < n; ++p) { // For every particle...
+            evaluate(p); // Calculate the value of the particle
+        }
+    }
+
+    // Run the optimization
+    for (int i = start; i < iterations; ++i) { // For every iteration...
+        for (size_t p = 0; p < n; ++p) { // For each particle in the swarm...
+            {
+                PhaseTimer timer(stats, Phase::move);
+                swarm.move(p); // Move the particle
+            }
+            evaluate(p); // Calculate the value of the new position and update its bests
+        }
+
+        if (monitor != nullptr && monitor->recording()) { // If the records replace the output...
+            monitor->record(i, swarm.best_value(), swarm.best_value());
+        } else if (verbose == 1) { // If the user wants verbose output...
+            std::cout << "Iteration: " << i << " Current Best: " << swarm.best_value() << std::endl; // Output the global best value
+        }
+        bool stopped = termination != nullptr && termination->stop(i + 1, swarm.best_value(), termination->measures_diversity() ? swarm.spread() : 0.0); // Whether the run ends early
+        save_swarm(checkpoint, swarm, i, i + 1, stopped ? i + 1 : iterations);
+        if (stopped) {
+            break;
+        }
+    }
+
+    if (monitor != nullptr) {
+        monitor->flush(); // Pass on the remaining records
+    }
+    if (verbose >= 0) { // If the user wants final output...
+        std::cout << "Best Value: " << swarm.best_value() << std::endl; // Output the global best value
+    }
+    return swarm.best_position(); // Return the global best position
+}
+
+// Particle swarm optimization evaluating the whole swarm at once - every particle moves, then the swarm is evaluated, then the bests are updated
+// evaluate(positions, n, dim, values) fills values[p] with the value of row p of the (n, dim) row-major positions, to be *maximized*
+template <typename T, typename EvaluateSwarm>
+std::vector<T> pso_synchronous(
+    EvaluateSwarm&& evaluate, // Evaluates the whole swarm - called as evaluate(const T* positions, size_t n, size_t dim, double* values)
+    const std::vector<T>& space_min, // Lower bound vector for the search space
+    const std::vector<T>& space_max, // Upper bound vector for the search space
+    int iterations = 100, // Number of iterations to run the algorithm for
+    int swarm_size = 100, // Number of particles in the swarm
+    double inertia = 0.5, // Inertia weight - recommended be in (0,1)
+    double cognitive = 1.0, // Cognitive weight - recommended be in [1,3]
+    double social = 2.0, // Social weight - recommended be in [1,3]
+    double clamp = 0.1, // Clamping limit on velocity
+    int verbose = 0, // Verbosity level - -1 for no output, 0 for final output, 1 for output at each iteration
+    Monitor* monitor = nullptr, // Collects stats and per-iteration records, or null
+    const Checkpoint* checkpoint = nullptr, // Where the swarm is saved and resumed from, or null
+    Termination* termination = nullptr, // Budgets and convergence tests that may end the run early, and the reason it ended, or null
+    long long rng_seed = -1 // Seed for the random number generator - negative for a nondeterministic seed
+) {
+    Swarm<T> swarm(space_min, space_max, swarm_size, inertia, cognitive, social, clamp, mix_seed(run_seed(rng_seed))); // Initialize the swarm
+    size_t n = swarm.size(); // Number of particles in the swarm
+    std::vector<double> values(n); // Values of every particle
+    Stats* stats = stats_of(monitor); // Per-phase timers, or null
+    int start = resume_swarm(checkpoint, swarm); // First iteration to run
+    if (termination != nullptr) {
+        termination->start(true); // The swarm maximizes
+    }
+
+    // Evaluate every particle and update the bests
+    auto evaluate_all = [&]() {
+        {
+            PhaseTimer timer(stats, Phase::objective);
+            evaluate(swarm.positions(), n, swarm.dimension(), values.data()); // Calculate the value of every particle
+        }
+        if (stats != nullptr) {
+            stats->count_evaluations(n);
+        }
+        if (termination != nullptr) {
+            termination->count_evaluations(n);
+        }
+        for (size_t p = 0; p < n; ++p) { // For each particle in the swarm...
+            swarm.update(p, values[p]); // Update the particle's value and bests
+        }
+    };
+
+    if (start == 0) { // If the swarm was not restored...
+        evaluate_all(); // Evaluate the initial positions
+    }
+
+    // Run the optimization
+    for (int i = start; i < iterations; ++i) { // For every iteration...
+        {
+            PhaseTimer timer(stats, Phase::move);
+            for (size_t p = 0; p < n; ++p) { // For each particle in the swarm...
+                swarm.move(p); // Move the particle
+            }
+        }
+        evaluate_all(); // Calculate the values of every new position
+
+        if (monitor != nullptr && monitor->recording()) { // If the records replace the output...
+            monitor->record(i, swarm.best_value(), swarm.best_value());
+        } else if (verbose == 1) { // If the user wants verbose output...
+            std::cout << "Iteration: " << i << " Current Best: " << swarm.best_value() << std::endl; // Output the global best value
+        }
+        bool stopped = termination != nullptr && termination->stop(i + 1, swarm.best_value(), termination->measures_diversity() ? swarm.spread() : 0.0); // Whether the run ends early
+        save_swarm(checkpoint, swarm, i, i + 1, stopped ? i + 1 : iterations);
+        if (stopped) {
+            break;
+        }
+    }
+
+    if (monitor != nullptr) {
+        monitor->flush(); // Pass on the remaining records
+    }
+    if (verbose >= 0) { // If the user wants final output...
+        std::cout << "Best Value: " << swarm.best_value() << std::endl; // Output the global best value
+    }
+    return swarm.best_position(); // Return the global best position
+}
+
+// Particle swarm optimization spreading the particles of each iteration over n_threads threads - funct must be thread-safe
+// Moves are synchronous, as in pso_synchronous, and a Release guard is held around each parallel loop
+template <typename Release = NoRelease, typename T, typename Funct>
+std::vector<T> pso_parallel(
+    Funct&& funct, // The function to be *maximized* - called as funct(const T* params, size_t n) from several threads
+    const std::vector<T>& space_min, // Lower bound vector for the search space
+    const std::vector<T>& space_max, // Upper bound vector for the search space
+    int iterations = 100, // Number of iterations to run the algorithm for
+    int swarm_size = 100, // Number of particles in the swarm
+    double inertia = 0.5, // Inertia weight - recommended be in (0,1)
+    double cognitive = 1.0, // Cognitive weight - recommended be in [1,3]
+    double social = 2.0, // Social weight - recommended be in [1,3]
+    double clamp = 0.1, // Clamping limit on velocity
+    int verbose = 0, // Verbosity level - -1 for no output, 0 for final output, 1 for output at each iteration
+    int n_threads = 0, // Number of threads - 0 uses every hardware thread
+    Monitor* monitor = nullptr, // Collects stats and per-iteration records, or null
+    const Checkpoint* checkpoint = nullptr, // Where the swarm is saved and resumed from, or null
+    Termination* termination = nullptr, // Budgets and convergence tests that may end the run early, and the reason it ended, or null
+    long long rng_seed = -1 // Seed for the random number generator - negative for a nondeterministic seed
+) {
+    ThreadPool pool(n_threads); // Threads evaluating the particles
+    return pso_synchronous([&](const T* positions, size_t n, size_t dim, double* values) {
+        Release release; // Let go of the caller's lock while the threads evaluate
+        pool.parallel_for(n, [&](size_t p, size_t) {
+            values[p] = funct(positions + p * dim, dim); // Calculate the value of the particle
+        });
+    }, space_min, space_max, iterations, swarm_size, inertia, cognitive, social, clamp, verbose, monitor, checkpoint, termination, rng_seed);
+}
+
+} // namespace quickopt
@@ -0,0 +1,16 @@
+#pragma once
+
+// Header-only C++ core of quickopt - the optimizers take any callable, and do not depend on Python
+// The Python modules in src/ are thin adapters over these headers
+#include "annealing.hpp"
+#include "bohb.hpp"
+#include "checkpoint.hpp"
+#include "eval_cache.hpp"
+#include "genetic.hpp"
+#include "pso.hpp"
+#include "random.hpp"
+#include "stats.hpp"
+#include "termination.hpp"
+#include "thread_pool.hpp"
+#include "tpe.hpp"
+#include "trial_log.hpp"
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+namespace quickopt {
+
+// Mixes a 64-bit value into a well-distributed 64-bit value (splitmix64), used to derive independent random number streams
+inline uint64_t mix_seed(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Seed every random number stream of a run is derived from - rng_seed itself, or a nondeterministic seed if it is negative
+inline uint64_t run_seed(long long rng_seed) {
+    if (rng_seed >= 0) { // If the run is to be reproducible...
+        return static_cast<uint64_t>(rng_seed);
+    }
+    return (static_cast<uint64_t>(std::random_device{}()) << 32) ^ std::random_device{}();
+}
+
+// Seed of random number stream number stream of a run, independent of the other streams derived from the same base seed
+inline uint64_t stream_seed(uint64_t base, uint64_t stream) {
+    return mix_seed(base ^ mix_seed(stream));
+}
+
+} // namespace quickopt
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace quickopt {
+
+// Phases of an optimizer run that are timed separately
+enum class Phase {
+    objective, // Calls to the objective or fitness function - includes marshalling for Python functions
+    marshalling, // Converting parameters and values between C++ and the calling language
+    move, // Moving the particles of a swarm
+    sort, // Ordering candidates by value - selection in genetic, ranking new trials in TPE
+    crossover, // Crossing parents over into children
+    mutation, // Mutating children
+    neighbor, // Generating annealing proposals
+    acceptance, // Accepting or rejecting annealing proposals, and replica exchanges
+    weights, // Computing the TPE candidate weights
+    kde, // Maintaining the TPE kernel density estimate
+    acquisition, // Drawing and scoring TPE acquisition samples
+    count // Number of phases
+};
+
+// Name of a phase, as reported in stats
+inline const char* phase_name(Phase phase) {
+    static const char* const names[] = {"objective", "marshalling", "move", "sort", "crossover", "mutation", "neighbor", "acceptance", "weights", "kde", "acquisition"};
+    return names[static_cast<size_t>(phase)];
+}
+
+// Time spent in each phase of a run and the number of times it was entered, plus the number of objective evaluations
+// Safe to share between threads - every counter is a relaxed atomic, so concurrent phases add up to more than the wall-clock time
+class Stats {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Add a timed span to a phase
+    void add(Phase phase, Clock::duration elapsed) {
+        Counter& c = counters[static_cast<size_t>(phase)];
+        c.nanoseconds.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()), std::memory_order_relaxed);
+        c.calls.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void count_evaluations(size_t n) { evaluation_count.fetch_add(n, std::memory_order_relaxed); } // Count objective evaluations
+
+    double seconds(Phase phase) const { return counters[static_cast<size_t>(phase)].nanoseconds.load(std::memory_order_relaxed) * 1e-9; } // Total time in a phase
+    uint64_t calls(Phase phase) const { return counters[static_cast<size_t>(phase)].calls.load(std::memory_order_relaxed); } // Number of timed spans of a phase
+    uint64_t evaluations() const { return evaluation_count.load(std::memory_order_relaxed); } // Number of objective evaluations
+
+private:
+    struct Counter {
+        std::atomic<uint64_t> nanoseconds{0};
+        std::atomic<uint64_t> calls{0};
+    };
+    Counter counters[static_cast<size_t>(Phase::count)];
+    std::atomic<uint64_t> evaluation_count{0};
+};
+
+// Scope timer adding its lifetime to a phase - does nothing, not even reading the clock, when stats is null
+class PhaseTimer {
+public:
+    PhaseTimer(Stats* stats, Phase phase) : stats(stats), phase(phase) {
+        if (stats != nullptr) {
+            start = Stats::Clock::now();
+        }
+    }
+    ~PhaseTimer() {
+        if (stats != nullptr) {
+            stats->add(phase, Stats::Clock::now() - start);
+        }
+    }
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    Stats* stats;
+    Phase phase;
+    Stats::Clock::time_point start;
+};
+
+// Progress of a run at the end of an iteration - what verbose output prints
+struct IterationRecord {
+    int iteration; // Iteration, generation or sweep
+    double best; // Best value so far, in the optimizer's own sense - maximized by pso and genetic, minimized by anneal and bayesopt_tpe
+    double current; // Current value - the swarm's best, the population's mean fitness, the chain's current value, or the last evaluated point
+    uint64_t evaluations; // Objective evaluations so far
+};
+
+// Observer of a run - collects stats, and buffers iteration records for a callback that replaces the per-iteration output of verbose
+// Records are passed on every `interval` iterations and when the run ends, always from the thread that called the optimizer
+class Monitor {
+public:
+    Stats stats; // Per-phase timers and counters
+    std::function<void(const std::vector<IterationRecord>&)> on_records; // Receives buffered records - none are kept when it is empty
+    size_t interval = 1; // Number of records buffered before on_records is called
+
+    bool recording() const { return static_cast<bool>(on_records); } // Whether records replace the per-iteration output
+
+    // Buffer a record, passing the buffer on once it is full
+    void record(int iteration, double best, double current) {
+        buffer.push_back(IterationRecord{iteration, best, current, stats.evaluations()});
+        if (buffer.size() >= interval) {
+            flush();
+        }
+    }
+
+    // Pass on the buffered records
+    void flush() {
+        if (!buffer.empty() && on_records) {
+            std::vector<IterationRecord> records;
+            records.swap(buffer); // Empty the buffer first, so a throwing callback does not see the records again
+            on_records(records);
+        }
+    }
+
+private:
+    std::vector<IterationRecord> buffer; // Records not passed on yet
+};
+
+// Stats of a monitor, or null if there is none
+inline Stats* stats_of(Monitor* monitor) { return monitor != nullptr ? &monitor->stats : nullptr; }
+
+} // namespace quickopt
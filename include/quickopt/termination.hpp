@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace quickopt {
+
+// Criterion that ended a run
+enum class StopReason {
+    iterations, // Every iteration, generation or sweep was run
+    evaluations, // The evaluation budget was used up
+    time, // The wall-clock budget was used up
+    target, // The best value reached the target
+    stagnation, // The best value did not improve for patience iterations
+    diversity // The swarm or population collapsed below the diversity threshold
+};
+
+// Name of a stop reason, as reported to the caller
+inline const char* stop_reason_name(StopReason reason) {
+    static const char* const names[] = {"iterations", "max_evaluations", "max_time", "target", "stagnation", "diversity"};
+    return names[static_cast<size_t>(reason)];
+}
+
+// Mean over the parameters of the standard deviation of n rows of dim parameters - the spread of a swarm or population
+// Only numeric parameters have a spread, so other types return NaN
+template <typename T>
+double parameter_spread(const T* rows, size_t n, size_t dim) {
+    if constexpr (std::is_arithmetic<T>::value) {
+        if (n == 0 || dim == 0) { // If there is nothing to spread...
+            return 0.0;
+        }
+        double total = 0; // Sum of the standard deviation of every parameter
+        for (size_t j = 0; j < dim; ++j) { // For each parameter...
+            double mean = 0, square = 0;
+            for (size_t i = 0; i < n; ++i) { // For each row...
+                double x = static_cast<double>(rows[i * dim + j]);
+                mean += x;
+                square += x * x;
+            }
+            mean /= n;
+            total += std::sqrt(std::max(0.0, square / n - mean * mean));
+        }
+        return total / dim;
+    } else {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+// Budgets and convergence tests that end a run before its iterations are used up - each is off at its default
+// They are checked after every iteration (generation, sweep, or epoch of the island model), so a run may overshoot max_evaluations by up to one iteration's evaluations
+// The budgets count from the start of the call, so a run resumed from a checkpoint gets them afresh
+class Termination {
+public:
+    uint64_t max_evaluations = 0; // Number of objective evaluations after which the run stops - 0 for no limit
+    double max_seconds = 0; // Wall-clock time after which the run stops - 0 for no limit
+    double target = std::numeric_limits<double>::quiet_NaN(); // Best value at which the run stops, in the optimizer's own sense - NaN for none
+    int patience = 0; // Number of iterations without an improvement of the best value after which the run stops - 0 to never stop
+    double tolerance = 0; // Smallest change of the best value that counts as an improvement
+    double min_diversity = 0; // Spread of the swarm or population (see parameter_spread) below which the run stops - 0 to never stop; only pso and genetic measure it
+
+    // Start a run - maximize tells which way the best value improves
+    void start(bool maximize) {
+        maximizing = maximize;
+        started_at = std::chrono::steady_clock::now();
+        evaluation_count.store(0, std::memory_order_relaxed);
+        stop_reason = StopReason::iterations;
+        completed = 0;
+        has_best = false;
+    }
+
+    void count_evaluations(size_t n) { evaluation_count.fetch_add(n, std::memory_order_relaxed); } // Count objective evaluations - safe to call from several threads
+
+    bool measures_diversity() const { return min_diversity > 0; } // Whether the optimizer must measure the spread of its swarm or population
+
+    // Whether the run stops after `done` iterations, given its best value so far and the spread of its swarm or population - records the reason if so
+    bool stop(int done, double best, double spread = std::numeric_limits<double>::quiet_NaN()) {
+        completed = done;
+        if (!has_best || (maximizing ? best - best_seen : best_seen - best) > tolerance) { // If the best value improved...
+            best_seen = best;
+            improved_at = done;
+            has_best = true;
+        }
+
+        if (!std::isnan(target) && (maximizing ? best >= target : best <= target)) { // If the target was reached...
+            stop_reason = StopReason::target;
+        } else if (max_evaluations > 0 && evaluations() >= max_evaluations) { // If the evaluation budget is used up...
+            stop_reason = StopReason::evaluations;
+        } else if (max_seconds > 0 && std::chrono::duration<double>(std::chrono::steady_clock::now() - started_at).count() >= max_seconds) { // If the time budget is used up...
+            stop_reason = StopReason::time;
+        } else if (patience > 0 && done - improved_at >= patience) { // If the best value stopped improving...
+            stop_reason = StopReason::stagnation;
+        } else if (measures_diversity() && spread < min_diversity) { // If the swarm or population collapsed...
+            stop_reason = StopReason::diversity;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    StopReason reason() const { return stop_reason; } // Criterion that ended the run
+    int iterations() const { return completed; } // Number of iterations completed when the run was last checked
+    uint64_t evaluations() const { return evaluation_count.load(std::memory_order_relaxed); } // Number of objective evaluations so far
+
+private:
+    bool maximizing = false; // Whether the best value improves upwards
+    std::chrono::steady_clock::time_point started_at; // When the run started
+    std::atomic<uint64_t> evaluation_count{0}; // Number of objective evaluations
+    StopReason stop_reason = StopReason::iterations; // Criterion that ended the run
+    int completed = 0; // Number of iterations completed
+    bool has_best = false; // Whether a best value was seen
+    double best_seen = 0; // Best value at the last improvement
+    int improved_at = 0; // Iteration count at the last improvement
+};
+
+} // namespace quickopt
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace quickopt {
+
+// Fixed-size pool of worker threads for running parallel loops - the calling thread also works, so a pool of size 1 spawns no threads
+class ThreadPool {
+public:
+    // Create a pool of n_threads threads, including the calling thread - 0 uses every hardware thread
+    explicit ThreadPool(int n_threads) {
+        size_t n = n_threads > 0 ? static_cast<size_t>(n_threads) : std::max(1u, std::thread::hardware_concurrency()); // Number of threads
+        for (size_t t = 1; t < n; ++t) { // For every thread besides the caller...
+            workers.emplace_back([this, t] { work(t); }); // Start a worker
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true; // Tell the workers to exit
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) { // For each worker...
+            worker.join(); // Wait for it to exit
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size() + 1; } // Number of threads, including the caller
+
+    // Call body(i, thread) for every i in [0, n), where thread in [0, size()) identifies the calling thread - blocks until every call returns
+    // The first exception thrown by body is rethrown here once the loop has finished
+    void parallel_for(size_t n, const std::function<void(size_t, size_t)>& body) {
+        if (workers.empty() || n <= 1) { // If there is nothing to share...
+            for (size_t i = 0; i < n; ++i) { // Run the loop on the caller
+                body(i, 0);
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task = &body; // Publish the loop
+            count = n;
+            next = 0;
+            active = workers.size(); // Every worker joins the loop
+            error = nullptr;
+            ++generation;
+        }
+        wake.notify_all();
+
+        run(0); // Work on the loop from the caller
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return active == 0; }); // Wait for the workers to finish
+        task = nullptr;
+        if (error) { // If the loop threw...
+            std::rethrow_exception(error); // Rethrow on the caller
+        }
+    }
+
+private:
+    // Take indices from the current loop until it is exhausted
+    void run(size_t thread) {
+        const std::function<void(size_t, size_t)>& body = *task;
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) { // For each index not yet taken...
+            try {
+                body(i, thread);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) { // Keep the first exception
+                    error = std::current_exception();
+                }
+                next = count; // Skip the remaining indices
+            }
+        }
+    }
+
+    // Worker loop - wait for a loop to be published, help run it, and report back
+    void work(size_t thread) {
+        size_t seen = 0; // Last loop this worker ran
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this, seen] { return stopping || generation != seen; });
+                if (stopping) { // If the pool is being destroyed...
+                    return;
+                }
+                seen = generation;
+            }
+            run(thread);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--active == 0) { // If this is the last worker to finish...
+                    done.notify_one();
+                }
+            }
+        }
+    }
+
+    std::vector<std::thread> workers; // Worker threads
+    std::mutex mutex; // Guards the loop state below
+    std::condition_variable wake; // Signals the workers that a loop was published or the pool is stopping
+    std::condition_variable done; // Signals the caller that every worker finished the loop
+    const std::function<void(size_t, size_t)>* task = nullptr; // Body of the current loop
+    size_t count = 0; // Number of indices in the current loop
+    std::atomic<size_t> next{0}; // Next index to take
+    size_t active = 0; // Number of workers still running the current loop
+    size_t generation = 0; // Number of loops published so far
+    std::exception_ptr error; // First exception thrown by the current loop
+    bool stopping = false; // Whether the pool is being destroyed
+};
+
+// Scope guard that does nothing - the default Release type of the engines, which hold one around each parallel loop
+// Language bindings substitute a guard that lets go of their interpreter's lock for the loop, such as py::gil_scoped_release
+struct NoRelease {
+    NoRelease() {} // User-provided, so a guard held for its scope is not reported as unused
+};
+
+} // namespace quickopt
@@ -0,0 +1,1055 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "checkpoint.hpp"
+#include "random.hpp"
+#include "stats.hpp"
+#include "termination.hpp"
+#include "thread_pool.hpp"
+#include "trial_log.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#endif
+
+namespace quickopt {
+
+// Computes log(exp(x[0]) + ... + exp(x[n - 1])), returning negative infinity for an empty range
+typedef double (*log_sum_exp_t)(const double* x, size_t n);
+
+// Scalar log-sum-exp - used as the fallback when no vector instructions are available
+inline double log_sum_exp_scalar(const double* x, size_t n) {
+    double m = -std::numeric_limits<double>::infinity(); // Largest term
+    for (size_t i = 0; i < n; ++i) { // For each term...
+        m = std::max(m, x[i]); // Update the largest term
+    }
+    if (m == -std::numeric_limits<double>::infinity()) { // If every term is zero in linear space...
+        return m; // The sum is zero
+    }
+    double sum = 0; // Sum of the terms, scaled by the largest term
+    for (size_t i = 0; i < n; ++i) { // For each term...
+        sum += std::exp(x[i] - m); // Add on the scaled term
+    }
+    return m + std::log(sum); // Undo the scaling
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define QUICKOPT_TPE_X86 1
+
+// AVX2 log-sum-exp - four terms at a time, with exp evaluated by range reduction and a degree 13 polynomial
+__attribute__((target("avx2")))
+inline double log_sum_exp_avx2(const double* x, size_t n) {
+    __m256d vm = _mm256_set1_pd(-std::numeric_limits<double>::infinity()); // Largest term in each lane
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) { // For every block of four terms...
+        vm = _mm256_max_pd(vm, _mm256_loadu_pd(x + i)); // Update the largest terms
+    }
+    double lanes[4]; // Lanes of the largest terms
+    _mm256_storeu_pd(lanes, vm);
+    double m = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3])); // Largest term
+    for (size_t j = i; j < n; ++j) { // For the remaining terms...
+        m = std::max(m, x[j]);
+    }
+    if (m == -std::numeric_limits<double>::infinity()) { // If every term is zero in linear space...
+        return m; // The sum is zero
+    }
+
+    const __m256d shift = _mm256_set1_pd(m); // Largest term, subtracted from every term
+    const __m256d lower = _mm256_set1_pd(-708.0); // Smallest exponent that does not underflow
+    const __m256d log2e = _mm256_set1_pd(1.4426950408889634); // log2(e)
+    const __m256d ln2_hi = _mm256_set1_pd(6.93147180369123816490e-01); // High part of ln(2)
+    const __m256d ln2_lo = _mm256_set1_pd(1.90821492927058770002e-10); // Low part of ln(2)
+    const __m256d round = _mm256_set1_pd(6755399441055744.0); // 1.5 * 2^52 - adding this rounds to an integer held in the low mantissa bits
+    const __m256i bias = _mm256_set1_epi64x(1023); // Exponent bias
+    static const double coeffs[14] = { // Taylor coefficients 1/13! ... 1/0!
+        1.0 / 6227020800.0, 1.0 / 479001600.0, 1.0 / 39916800.0, 1.0 / 3628800.0, 1.0 / 362880.0, 1.0 / 40320.0, 1.0 / 5040.0,
+        1.0 / 720.0, 1.0 / 120.0, 1.0 / 24.0, 1.0 / 6.0, 0.5, 1.0, 1.0};
+
+    __m256d vsum = _mm256_setzero_pd(); // Sum of the scaled terms in each lane
+    for (i = 0; i + 4 <= n; i += 4) { // For every block of four terms...
+        __m256d v = _mm256_max_pd(_mm256_sub_pd(_mm256_loadu_pd(x + i), shift), lower); // Scale and clamp the exponents
+        __m256d k = _mm256_add_pd(_mm256_mul_pd(v, log2e), round); // Round v / ln(2) to the nearest integer k
+        __m256i kbits = _mm256_castpd_si256(k); // Integer k, held in the low bits
+        k = _mm256_sub_pd(k, round);
+        __m256d r = _mm256_sub_pd(_mm256_sub_pd(v, _mm256_mul_pd(k, ln2_hi)), _mm256_mul_pd(k, ln2_lo)); // Remainder r = v - k * ln(2), with |r| <= ln(2) / 2
+        __m256d p = _mm256_set1_pd(coeffs[0]);
+        for (int c = 1; c < 14; ++c) { // Evaluate the polynomial for exp(r) using Horner's method
+            p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(coeffs[c]));
+        }
+        __m256d scale = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_add_epi64(kbits, bias), 52)); // Build 2^k from its exponent bits
+        vsum = _mm256_add_pd(vsum, _mm256_mul_pd(p, scale)); // Add on exp(v) = exp(r) * 2^k
+    }
+    _mm256_storeu_pd(lanes, vsum);
+    double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]); // Sum of the scaled terms
+    for (; i < n; ++i) { // For the remaining terms...
+        sum += std::exp(x[i] - m);
+    }
+    return m + std::log(sum); // Undo the scaling
+}
+#endif
+
+// Select the widest log-sum-exp supported by the running CPU
+inline log_sum_exp_t tpe_select_log_sum_exp() {
+#ifdef QUICKOPT_TPE_X86
+    __builtin_cpu_init(); // Initialize the CPU feature detection
+    if (__builtin_cpu_supports("avx2")) { // If the CPU supports AVX2...
+        return log_sum_exp_avx2;
+    }
+#endif
+    return log_sum_exp_scalar; // Otherwise fall back to the scalar version
+}
+
+// KD-tree over a set of weighted centers, used to approximate a Gaussian kernel sum with a bounded relative error
+// Nodes whose kernel values provably vary by little are summed from their bounds instead of their centers, based on Gray and Moore 2003
+class TPEKDTree {
+public:
+    // Build the tree over centers [begin, end) of the column-wise centers, with the given log weights and scaling
+    void build(const std::vector<std::vector<double>>& centers, const std::vector<double>& log_weights, const std::vector<double>& inv_two_var, size_t begin, size_t end) {
+        dim = centers.size(); // Number of dimensions
+        count = end - begin; // Number of centers
+        points.resize(count * dim); // Centers stored row-wise in tree order
+        weights.resize(count); // Weights in tree order
+        tree_log_weights.resize(count); // Log weights in tree order
+        nodes.clear(); // Remove the old nodes
+        boxes.clear(); // Remove the old bounding boxes
+        std::vector<size_t> order(count); // Order of the centers in the tree
+        for (size_t i = 0; i < count; i++) { // For each center...
+            order[i] = begin + i;
+        }
+        if (count > 0) { // If there are centers...
+            build_node(centers, inv_two_var, order, 0, count); // Build the tree from the root
+        }
+        for (size_t i = 0; i < count; i++) { // For each center, in tree order...
+            for (size_t d = 0; d < dim; d++) { // For each dimension...
+                points[i * dim + d] = centers[d][order[i]]; // Copy the center's parameter
+            }
+            tree_log_weights[i] = log_weights[order[i]]; // Keep the center's log weight for the exact fallback
+            weights[i] = std::exp(log_weights[order[i]]); // Store the center's weight in linear space
+        }
+        for (size_t k = nodes.size(); k-- > 0;) { // For each node, children before parents...
+            Node& node = nodes[k];
+            node.weight = 0; // Initialize the node's weight to zero
+            if (node.left < 0) { // If the node is a leaf...
+                for (size_t i = node.begin; i < node.end; i++) { // For each of its centers...
+                    node.weight += weights[i]; // Add on the center's weight
+                }
+            } else { // If not...
+                node.weight = nodes[node.left].weight + nodes[node.right].weight; // Add on the children's weights
+            }
+        }
+    }
+
+    // Calculate the log of the weighted sum of unnormalized kernels at a point, to within a relative error of tolerance
+    double log_sum(const double* params, const std::vector<double>& inv_two_var, double tolerance) const {
+        if (count == 0 || !(nodes[0].weight > 0)) { // If there are no centers with weight...
+            return -std::numeric_limits<double>::infinity(); // The sum is zero
+        }
+
+        // Offset the exponents by the distance to the nearest leaf found greedily, so the kernels do not underflow
+        size_t k = 0;
+        while (nodes[k].left >= 0) { // While the node has children...
+            const Node& node = nodes[k];
+            k = box_min(nodes[node.left], params, inv_two_var) <= box_min(nodes[node.right], params, inv_two_var) ? node.left : node.right; // Descend into the closer child
+        }
+        double offset = std::numeric_limits<double>::infinity();
+        for (size_t i = nodes[k].begin; i < nodes[k].end; i++) { // For each center in the leaf...
+            offset = std::min(offset, distance(i, params, inv_two_var)); // Find the closest center
+        }
+        offset = std::min(offset, box_min(nodes[0], params, inv_two_var) + 600.0); // Keep the closest possible kernel from overflowing
+
+        double total = 0; // Running estimate of the weighted sum of the offset kernels
+        double bound = 0; // Running lower bound on the same sum, which the pruning is measured against
+        visit(0, params, inv_two_var, tolerance / nodes[0].weight, offset, total, bound); // Sum over the tree from the root
+        if (!(total > 0)) { // If every kernel underflowed, e.g. because the nearest leaf's centers have no weight...
+            return exact_log_sum(params, inv_two_var); // Sum in log-space instead
+        }
+        return std::log(total) - offset; // Undo the offset
+    }
+
+private:
+    struct Node {
+        size_t begin, end; // Range of the node's centers in tree order
+        int left, right; // Children of the node, -1 for leaves
+        double weight; // Total weight of the node's centers
+    };
+
+    static const size_t leaf_size = 32; // Maximum number of centers in a leaf
+
+    // Recursively build the node over order[begin, end), splitting at the median of the widest scaled dimension
+    int build_node(const std::vector<std::vector<double>>& centers, const std::vector<double>& inv_two_var, std::vector<size_t>& order, size_t begin, size_t end) {
+        int index = static_cast<int>(nodes.size()); // Index of the new node
+        nodes.push_back(Node{begin, end, -1, -1, 0.0}); // Add the node
+        boxes.resize(boxes.size() + 2 * dim); // Add the node's bounding box
+        double* lo = &boxes[index * 2 * dim]; // Lower corner of the bounding box
+        double* hi = lo + dim; // Upper corner of the bounding box
+
+        size_t widest = 0; // Dimension with the widest scaled spread
+        double widest_spread = -1;
+        for (size_t d = 0; d < dim; d++) { // For each dimension...
+            lo[d] = std::numeric_limits<double>::infinity();
+            hi[d] = -std::numeric_limits<double>::infinity();
+            for (size_t i = begin; i < end; i++) { // For each center in the node...
+                lo[d] = std::min(lo[d], centers[d][order[i]]);
+                hi[d] = std::max(hi[d], centers[d][order[i]]);
+            }
+            double spread = (hi[d] - lo[d]) * (hi[d] - lo[d]) * inv_two_var[d]; // Spread measured in bandwidths
+            if (spread > widest_spread) { // If this is the widest dimension so far...
+                widest_spread = spread;
+                widest = d;
+            }
+        }
+
+        if (end - begin <= leaf_size || widest_spread <= 0) { // If the node is small enough, or all its centers coincide...
+            return index; // Leave it as a leaf
+        }
+
+        size_t mid = begin + (end - begin) / 2; // Median position
+        const std::vector<double>& column = centers[widest];
+        std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end, [&column](size_t a, size_t b) { // Partition the centers around the median
+            return column[a] < column[b];
+        });
+        int left = build_node(centers, inv_two_var, order, begin, mid); // Build the lower child
+        int right = build_node(centers, inv_two_var, order, mid, end); // Build the upper child
+        nodes[index].left = left;
+        nodes[index].right = right;
+        return index;
+    }
+
+    // Scaled squared distance between a point and the center at position i in tree order
+    double distance(size_t i, const double* params, const std::vector<double>& inv_two_var) const {
+        double q = 0;
+        for (size_t d = 0; d < dim; d++) { // For each dimension...
+            double diff = params[d] - points[i * dim + d];
+            q += diff * diff * inv_two_var[d];
+        }
+        return q;
+    }
+
+    // Smallest scaled squared distance between a point and a node's bounding box
+    double box_min(const Node& node, const double* params, const std::vector<double>& inv_two_var) const {
+        const double* lo = &boxes[(&node - nodes.data()) * 2 * dim];
+        const double* hi = lo + dim;
+        double q = 0;
+        for (size_t d = 0; d < dim; d++) { // For each dimension...
+            double diff = params[d] < lo[d] ? lo[d] - params[d] : (params[d] > hi[d] ? params[d] - hi[d] : 0.0); // Distance to the box in this dimension
+            q += diff * diff * inv_two_var[d];
+        }
+        return q;
+    }
+
+    // Largest scaled squared distance between a point and a node's bounding box
+    double box_max(const Node& node, const double* params, const std::vector<double>& inv_two_var) const {
+        const double* lo = &boxes[(&node - nodes.data()) * 2 * dim];
+        const double* hi = lo + dim;
+        double q = 0;
+        for (size_t d = 0; d < dim; d++) { // For each dimension...
+            double diff = std::max(std::fabs(params[d] - lo[d]), std::fabs(params[d] - hi[d])); // Distance to the far side of the box in this dimension
+            q += diff * diff * inv_two_var[d];
+        }
+        return q;
+    }
+
+    // Log of the weighted sum of unnormalized kernels over every center, summed exactly in log-space
+    double exact_log_sum(const double* params, const std::vector<double>& inv_two_var) const {
+        std::vector<double> terms(count); // Log of each weighted kernel
+        for (size_t i = 0; i < count; i++) { // For each center...
+            terms[i] = tree_log_weights[i] - distance(i, params, inv_two_var);
+        }
+        return log_sum_exp_scalar(terms.data(), count);
+    }
+
+    // Add a node's contribution to the running total, approximating it when its error fits in its share of the tolerance
+    // The share is measured against bound, which only ever grows by a node's smallest possible contribution, so it stays a lower bound on the final sum
+    void visit(int k, const double* params, const std::vector<double>& inv_two_var, double tolerance_per_weight, double offset, double& total, double& bound) const {
+        const Node& node = nodes[k];
+        if (!(node.weight > 0)) { // If the node has no weight...
+            return; // It contributes nothing
+        }
+        double kmax = std::exp(offset - box_min(node, params, inv_two_var)); // Largest possible kernel value in the node
+        double kmin = std::exp(offset - box_max(node, params, inv_two_var)); // Smallest possible kernel value in the node
+        if ((kmax - kmin) / 2 <= tolerance_per_weight * (bound + node.weight * kmin)) { // If the midpoint estimate is within the node's share of the error...
+            total += node.weight * (kmax + kmin) / 2; // Approximate the node's contribution
+            bound += node.weight * kmin; // Only its smallest possible contribution is certain
+            return;
+        }
+        if (node.left < 0) { // If the node is a leaf...
+            for (size_t i = node.begin; i < node.end; i++) { // For each of its centers...
+                double exact = weights[i] * std::exp(offset - distance(i, params, inv_two_var)); // Exact contribution of the center
+                total += exact;
+                bound += exact;
+            }
+            return;
+        }
+        int first = node.left, second = node.right; // Visit the closer child first, so the lower bound grows quickly
+        if (box_min(nodes[second], params, inv_two_var) < box_min(nodes[first], params, inv_two_var)) {
+            std::swap(first, second);
+        }
+        visit(first, params, inv_two_var, tolerance_per_weight, offset, total, bound);
+        visit(second, params, inv_two_var, tolerance_per_weight, offset, total, bound);
+    }
+
+    size_t dim = 0; // Number of dimensions
+    size_t count = 0; // Number of centers
+    std::vector<double> points; // Centers stored row-wise in tree order
+    std::vector<double> weights; // Weight of each center in tree order
+    std::vector<double> tree_log_weights; // Log weight of each center in tree order
+    std::vector<Node> nodes; // Nodes of the tree, with the root first
+    std::vector<double> boxes; // Bounding box of each node, as dim lower bounds followed by dim upper bounds
+};
+
+// Weighted Gaussian kernel density estimate over a set of centers, evaluated in log-space
+// The centers are kept sorted by value, so the good set is the first `split` centers and the bad set is the rest
+// This is based on the multivariate kernel density estimation used in Falkner et al. 2018, with the Gaussian kernel described in Watanabe 2023
+class TPEKernelDensity {
+public:
+    // Sets with fewer centers than this are always summed exactly
+    static const size_t tree_threshold = 1024;
+
+    // Create a density estimate over dim dimensions, either exact or tree-based with a relative error of at most tolerance
+    TPEKernelDensity(size_t dim, bool use_tree = false, double tolerance = 0.0)
+        : dim(dim), centers(dim), inv_two_var(dim, 0.0), log_norm(0.0), use_tree(use_tree), tolerance(tolerance) {}
+
+    size_t size() const { return log_weights.size(); } // Number of centers
+
+    // Update the bandwidth, recomputing the per-dimension kernel normalizers only if it has changed
+    void set_bandwidth(const std::vector<double>& bw) {
+        if (bw == bandwidth) { // If the bandwidth is unchanged...
+            return; // The cached normalizers are still valid
+        }
+        bandwidth = bw; // Store the new bandwidth
+        log_norm = 0; // Initialize the log of the kernel normalizer to zero
+        for (size_t d = 0; d < dim; d++) { // For each dimension...
+            inv_two_var[d] = 1.0 / (2 * bw[d] * bw[d]); // Cache 1 / (2 * bw^2)
+            log_norm -= 0.5 * std::log(2 * M_PI * bw[d] * bw[d]); // Multiply in 1 / sqrt(2 * pi * bw^2)
+        }
+        trees_stale = true; // The trees split on scaled distances, so they must be rebuilt
+    }
+
+    // Insert a center at a given position in the sorted order - only this center is added, the rest are reused
+    void insert(size_t pos, const std::vector<double>& params) { insert(pos, params.data()); }
+    void insert(size_t pos, const double* params) {
+        for (size_t d = 0; d < dim; d++) { // For each dimension...
+            centers[d].insert(centers[d].begin() + pos, params[d]); // Insert the parameter into the dimension's column
+        }
+        log_weights.insert(log_weights.begin() + pos, -std::numeric_limits<double>::infinity()); // Weights are set separately
+        trees_stale = true; // The trees no longer cover every center
+    }
+
+    // Remove the center at a given position in the sorted order
+    void erase(size_t pos) {
+        for (size_t d = 0; d < dim; d++) { // For each dimension...
+            centers[d].erase(centers[d].begin() + pos); // Remove the parameter from the dimension's column
+        }
+        log_weights.erase(log_weights.begin() + pos); // Remove the weight
+        trees_stale = true; // The trees cover a removed center
+    }
+
+    // Set the weight of the center at a given position
+    void set_weight(size_t pos, double w) {
+        log_weights[pos] = w > 0 ? std::log(w) : -std::numeric_limits<double>::infinity(); // Non-positive weights contribute nothing
+        trees_stale = true; // The trees' node weights are out of date
+    }
+
+    // Bring the trees up to date for a given number of good centers - must be called before evaluate whenever the centers, weights or bandwidth change
+    void prepare(size_t split) {
+        size_t n = log_weights.size(); // Number of centers
+        if (use_tree && (trees_stale || split != tree_split)) { // If the trees are in use and out of date...
+            good_tree.build(centers, log_weights, inv_two_var, 0, split); // Rebuild the good set's tree
+            bad_tree.build(centers, log_weights, inv_two_var, split, n); // Rebuild the bad set's tree
+            tree_split = split;
+            trees_stale = false;
+        }
+    }
+
+    // Calculate the log of the good and bad densities at a point, given the number of good centers
+    // The scratch buffer is owned by the caller, so several threads can evaluate at once with their own buffers
+    void evaluate(const double* params, size_t split, double& log_good, double& log_bad, std::vector<double>& scratch) const {
+        size_t n = log_weights.size(); // Number of centers
+        scratch.resize(n); // Make room for one term per center
+        if (!use_tree || (split < tree_threshold && n - split < tree_threshold)) { // If both sets are summed exactly...
+            exact(params, 0, n, scratch); // Calculate every term in a single pass over the centers
+            log_good = log_mean(log_sum_exp(scratch.data(), split), split); // Log of the good density
+            log_bad = log_mean(log_sum_exp(scratch.data() + split, n - split), n - split); // Log of the bad density
+            return;
+        }
+
+        log_good = log_mean(log_sum_range(params, good_tree, 0, split, scratch), split); // Log of the good density
+        log_bad = log_mean(log_sum_range(params, bad_tree, split, n, scratch), n - split); // Log of the bad density
+    }
+
+private:
+    // Log-sum-exp, selected once at runtime
+    static double log_sum_exp(const double* x, size_t n) {
+        static const log_sum_exp_t selected = tpe_select_log_sum_exp();
+        return selected(x, n);
+    }
+
+    // Calculate the log of each weighted, unnormalized kernel for centers [begin, end) into the scratch buffer
+    void exact(const double* params, size_t begin, size_t end, std::vector<double>& scratch) const {
+        std::copy(log_weights.begin() + begin, log_weights.begin() + end, scratch.begin() + begin); // Start each term at the log of its weight
+        for (size_t d = 0; d < dim; d++) { // For each dimension...
+            const double x = params[d]; // Parameter value in this dimension
+            const double inv = inv_two_var[d]; // Cached 1 / (2 * bw^2) for this dimension
+            const double* column = centers[d].data(); // Centers' values in this dimension
+            double* out = scratch.data();
+            for (size_t i = begin; i < end; i++) { // For each center...
+                double diff = x - column[i];
+                out[i] -= diff * diff * inv; // Add on the log of the kernel's exponent
+            }
+        }
+    }
+
+    // Log of the weighted sum of unnormalized kernels over centers [begin, end), using the tree unless the set is small
+    double log_sum_range(const double* params, const TPEKDTree& tree, size_t begin, size_t end, std::vector<double>& scratch) const {
+        if (end - begin < tree_threshold) { // If the set is small...
+            exact(params, begin, end, scratch); // Fall back to the exact sum
+            return log_sum_exp(scratch.data() + begin, end - begin);
+        }
+        return tree.log_sum(params, inv_two_var, tolerance);
+    }
+
+    // Scale a log-sum of kernels by the normalizer and the number of centers, where an empty set has zero density
+    double log_mean(double log_sum, size_t count) const {
+        if (count == 0) { // If there are no centers...
+            return -std::numeric_limits<double>::infinity(); // The density is zero
+        }
+        return log_sum + log_norm - std::log(static_cast<double>(count));
+    }
+
+    size_t dim; // Number of dimensions
+    std::vector<std::vector<double>> centers; // Centers stored column-wise - centers[d][i] is dimension d of center i
+    std::vector<double> log_weights; // Log of the weight of each center
+    std::vector<double> bandwidth; // Bandwidth the normalizers were computed for
+    std::vector<double> inv_two_var; // Cached 1 / (2 * bw^2) for each dimension
+    double log_norm; // Cached log of the product of the per-dimension kernel normalizers
+
+    bool use_tree; // Whether large sets are summed approximately with KD-trees
+    double tolerance; // Relative error tolerance of the tree sums
+    TPEKDTree good_tree; // Tree over the good set
+    TPEKDTree bad_tree; // Tree over the bad set
+    size_t tree_split = 0; // Number of good centers the trees were built for
+    bool trees_stale = true; // Whether the trees must be rebuilt before use
+};
+
+// Computes log(exp(a) + exp(b))
+inline double log_add_exp(double a, double b) {
+    if (a == -std::numeric_limits<double>::infinity()) { // If the first term is zero in linear space...
+        return b;
+    }
+    if (b == -std::numeric_limits<double>::infinity()) { // If the second term is zero in linear space...
+        return a;
+    }
+    double m = std::max(a, b); // Largest term
+    return m + std::log1p(std::exp(-std::fabs(a - b))); // Add the terms, scaled by the largest
+}
+
+// Draws from a Gaussian truncated to [lo, hi] by rejection, falling back to the nearest bound if the Gaussian rarely lands inside
+template <typename Engine>
+double tpe_truncated_normal(Engine& stream, std::normal_distribution<double>& normal, double mean, double sigma, double lo, double hi) {
+    for (int attempt = 0; attempt < 64; attempt++) { // For each attempt...
+        double x = mean + sigma * normal(stream); // Draw from the untruncated Gaussian
+        if (x >= lo && x <= hi) { // If it is within the bounds...
+            return x;
+        }
+    }
+    return std::min(std::max(mean, lo), hi); // Clamp the mean into the bounds
+}
+
+// Store of evaluated trials - parameters are kept in a flat, append-only row-major matrix, with an index of trial ids sorted by value
+// The good and bad sets are the rank ranges [0, split) and [split, size()) of the index, so they are never copied
+class TPETrialStore {
+public:
+    explicit TPETrialStore(size_t dim) : dim(dim) {}
+
+    size_t size() const { return values.size(); } // Number of trials
+
+    void reserve(size_t n) { // Reserve space for n trials
+        params.reserve(n * dim);
+        values.reserve(n);
+        order.reserve(n);
+    }
+
+    // Add a trial, returning its rank in the sorted index - trials with equal values keep their insertion order
+    size_t add(const std::vector<double>& p, double value) { return add(p.data(), value); }
+    size_t add(const double* p, double value) {
+        size_t id = values.size(); // Id of the new trial
+        params.insert(params.end(), p, p + dim); // Append the parameters to the matrix
+        values.push_back(value); // Append the value
+        size_t rank = std::upper_bound(order.begin(), order.end(), value, [this](double v, size_t other) { // Binary search for the trial's rank
+            return v < values[other];
+        }) - order.begin();
+        order.insert(order.begin() + rank, id); // Insert the trial's id into the index
+        return rank;
+    }
+
+    double value(size_t rank) const { return values[order[rank]]; } // Value of the trial at a given rank
+    const double* row(size_t rank) const { return &params[order[rank] * dim]; } // Parameters of the trial at a given rank
+    const std::vector<double>& trial_params() const { return params; } // Parameters of every trial in insertion order
+    const std::vector<double>& trial_values() const { return values; } // Value of every trial in insertion order
+
+private:
+    size_t dim; // Number of parameters per trial
+    std::vector<double> params; // Parameters of every trial, one row per trial in insertion order
+    std::vector<double> values; // Value of every trial in insertion order
+    std::vector<size_t> order; // Trial ids sorted by value
+};
+
+// Check the settings shared by bayesopt_tpe and bohb, throwing an exception for the first invalid one
+// points is the number of trials the threshold is checked against, and points_name its name in the message
+inline void check_tpe_settings(
+    const std::vector<double>& space_min, const std::vector<double>& space_max, int iterations, int points, const std::string& points_name,
+    int acquisition_samples, double threshold, int group_cap, const std::vector<double>& bandwidth, double split,
+    const std::string& kde, double kde_tolerance, int n_threads, const std::string& sampling
+) {
+    if (threshold > std::sqrt(points)) { // If the threshold is greater than the square root of the number of points...
+        throw std::invalid_argument("Threshold value must be at most √(" + points_name + ")!"); // Throw an exception
+    }
+    if (threshold <= 0) { // If the threshold is less than or equal to 0...
+        throw std::invalid_argument("Threshold value must be positive!"); // Throw an exception
+    }
+    if (split != -107.2931 && (split < 0 || split > 1)) { // If the split value is not the default value and is not within the range [0, 1]...
+        throw std::invalid_argument("Split value must be within 0 and 1!"); // Throw an exception
+    }
+    if (group_cap < 2) { // If the group cap is less than 2...
+        throw std::invalid_argument("Group cap must be over 2!"); // Throw an exception
+    }
+    if (space_min.size() != space_max.size()) { // If the size of the lower bound vector is not equal to the size of the upper bound vector...
+        throw std::invalid_argument("Lower and upper bound vectors must be of the same size!"); // Throw an exception
+    }
+    if (bandwidth.size() != 0 && bandwidth.size() != space_min.size()) { // If the bandwidth vector is not empty and is not the same size as the search space...
+        throw std::invalid_argument("Bandwidth vector must be empty or of the same size as the search space!"); // Throw an exception
+    }
+    for (size_t i = 0; i < space_min.size(); i++) { // For each dimension in the search space...
+        if (space_min[i] >= space_max[i]) { // If the lower bound is greater than or equal to the upper bound...
+            throw std::invalid_argument("Lower bound must be less than upper bound for all dimensions!"); // Throw an exception
+        }
+    }
+    if (iterations <= 0) { // If the number of iterations is less than or equal to 0...
+        throw std::invalid_argument("Number of iterations must be positive!"); // Throw an exception
+    }
+    if (acquisition_samples <= 0) { // If the number of acquisition samples is less than or equal to 0...
+        throw std::invalid_argument("Number of acquisition samples must be positive!"); // Throw an exception
+    }
+    if (kde != "exact" && kde != "tree") { // If the kernel density estimation method is unknown...
+        throw std::invalid_argument("KDE method must be \"exact\" or \"tree\"!"); // Throw an exception
+    }
+    if (sampling != "uniform" && sampling != "mixture") { // If the sampling method is unknown...
+        throw std::invalid_argument("Sampling method must be \"uniform\" or \"mixture\"!"); // Throw an exception
+    }
+    if (n_threads < 0) { // If the number of threads is negative...
+        throw std::invalid_argument("Number of threads must be non-negative!"); // Throw an exception
+    }
+    if (kde_tolerance < 0) { // If the KDE tolerance is negative...
+        throw std::invalid_argument("KDE tolerance must be non-negative!"); // Throw an exception
+    }
+}
+
+// Bandwidth of each dimension's kernels for a given number of trials
+// This calculation is based on the heuristic in appendix C.3.3 of Watanabe 2023
+inline std::vector<double> tpe_bandwidth(const std::vector<double>& space_min, const std::vector<double>& space_max, double trials) {
+    std::vector<double> bandwidth(space_min.size());
+    for (size_t d = 0; d < space_min.size(); d++) { // For each dimension...
+        bandwidth[d] = ((space_max[d] - space_min[d]) / 5.0) * (pow(trials, (-1.0 / (space_min.size() + 4))));
+    }
+    return bandwidth;
+}
+
+// TPE model of a set of trials - splits them into good and bad sets, weights their kernels, and proposes the acquisition sample
+// that maximizes the ratio of the good density to the bad, each mixed with a non-informative prior
+// The trials and their density estimate are kept by the caller, and passed to fit and to each proposal
+class TPEModel {
+public:
+    TPEModel(
+        const std::vector<double>& space_min, // Lower bound vector for the search space
+        const std::vector<double>& space_max, // Upper bound vector for the search space
+        double threshold, // Threshold value for the splitting function - unnecessary if split is provided
+        double split, // Optional splitting threshold (overrides dynamic threshold calculation)
+        int group_cap, // Group cap for the good set
+        int prior_weight, // Prior weight parameter for Non-Informative Prior
+        int acquisition_samples, // Number of samples to draw for acquisition function maximization
+        bool mixture, // Whether acquisition samples are drawn from the good set's density and the prior rather than uniformly
+        size_t threads // Number of threads the samples are scored on
+    ) : space_min(space_min), space_max(space_max), dim(space_min.size()), threshold(threshold), split(split), group_cap(group_cap),
+        prior_weight(prior_weight), mixture(mixture), prior_mean(dim), prior_sigma(dim), prior_inv_two_var(dim),
+        acsamples(static_cast<size_t>(acquisition_samples) * dim), acscores(acquisition_samples), scratch(threads) {
+
+        // Non-informative prior, a Gaussian with a mean at the midpoint of the search space and a standard deviation of the search space width
+        // This is based on Watanabe 2023
+        prior_log_norm = std::log(static_cast<double>(prior_weight)); // Log of the prior's normalizer, scaled by the prior weight
+        for (size_t d = 0; d < dim; d++) { // For each dimension...
+            double sigma = space_max[d] - space_min[d]; // Calculate the standard deviation of the search space
+            prior_mean[d] = (space_min[d] + space_max[d]) / 2.0; // Calculate the mean of the search space
+            prior_sigma[d] = sigma;
+            prior_inv_two_var[d] = 1.0 / (2 * sigma * sigma);
+            prior_log_norm -= std::log(sigma * std::sqrt(2 * M_PI));
+        }
+    }
+
+    // Split the trials into good and bad sets, weight every kernel of their density estimate and set its bandwidth - returns the size of the good set
+    // The weights are based on the expected improvement acquisition function shown in Song et al. 2022
+    size_t fit(const TPETrialStore& dataset, TPEKernelDensity& density, const std::vector<double>& bandwidth, Stats* stats = nullptr) {
+        good_size = std::min(static_cast<size_t>(std::min(std::max(2, static_cast<int>(std::floor(dataset.size() * splitting(dataset.size())))), group_cap)), dataset.size()); // Size of the good set
+        bad_size = dataset.size() - good_size; // Size of the bad set
+        kernel_bandwidth = bandwidth;
+
+        double w0 = 0; // Weight of the zeroth basis in the KDE, the average over the good set of the denominator times each candidate's weight
+        {
+            PhaseTimer timer(stats, Phase::weights);
+            double denominator = denominator_of(dataset); // Denominator of the good candidates' weights
+            double yq = dataset.value(good_size - 1); // Value of the last good candidate
+            for (size_t j = 0; j < good_size; j++) { // For each candidate in the good set...
+                double w = (yq - dataset.value(j)) / denominator; // Calculate the weight of the candidate
+                density.set_weight(j, w); // Update the weight of its center
+                w0 += denominator * w; // Add on the weight of the candidate
+            }
+            w0 /= good_size; // Average over the good set
+
+            for (size_t j = good_size; j < dataset.size(); j++) { // For each candidate in the bad set...
+                density.set_weight(j, 1.0 / (bad_size + 1)); // Weight it by the size of the bad set
+            }
+
+            if (mixture) { // If acquisition samples are drawn from the good set's density...
+                // The good density is the mean of the weighted kernels, and the prior is added with weight w0 - the same mixture the acquisition function scores
+                mixture_cdf.assign(good_size + 1, 0.0);
+                double total = 0; // Running sum of the mixture weights
+                for (size_t j = 0; j <= good_size; j++) { // For each good candidate, then the prior...
+                    double w = j < good_size ? (yq - dataset.value(j)) / denominator / good_size : w0 * prior_weight; // Weight of the component
+                    total += std::isfinite(w) && w > 0 ? w : 0.0; // Components without a usable weight are never drawn
+                    mixture_cdf[j] = total;
+                }
+            }
+        }
+        {
+            PhaseTimer timer(stats, Phase::kde);
+            density.set_bandwidth(bandwidth); // Update the bandwidth, reusing the cached normalizers if it has not changed
+        }
+        log_w0 = w0 > 0 ? std::log(w0) : -std::numeric_limits<double>::infinity(); // Log of the weight of the zeroth basis
+        return good_size;
+    }
+
+    // Constant liar - pretend a set of parameters was observed with a bad value, so the next proposal is pushed elsewhere
+    // The fantasized observations are added after the trials, and must be erased from the density estimate before it is fitted again
+    void fantasize(TPEKernelDensity& density, const double* params) {
+        density.insert(density.size(), std::vector<double>(params, params + dim)); // Add the fantasized observation to the bad set
+        bad_size++; // The bad set has grown
+        for (size_t j = good_size; j < density.size(); j++) { // For each candidate in the bad set...
+            density.set_weight(j, 1.0 / (bad_size + 1)); // Update its weight for the new bad set size
+        }
+    }
+
+    // Score every acquisition sample with the fitted model, first drawing new samples if draw is set
+    // Each block of samples draws from its own stream, seeded by key and the block, so results do not depend on the number of threads
+    template <typename Release = NoRelease>
+    void score(const TPETrialStore& dataset, TPEKernelDensity& density, ThreadPool& pool, uint64_t base_seed, uint64_t key, bool draw, Stats* stats = nullptr) {
+        {
+            PhaseTimer timer(stats, Phase::kde);
+            density.prepare(good_size); // Bring the density estimate up to date before it is shared between threads
+        }
+        PhaseTimer timer(stats, Phase::acquisition);
+        Release release; // Generating and scoring samples does not call the function, so let go of the caller's lock
+        size_t blocks = (acscores.size() + block_size - 1) / block_size; // Number of blocks of acquisition samples
+        pool.parallel_for(blocks, [&](size_t block, size_t thread) {
+            size_t end = std::min(acscores.size(), (block + 1) * block_size); // End of the block
+            if (draw) { // If the samples are new...
+                std::mt19937_64 stream(stream_seed(base_seed, (key << 32) | block)); // Random number stream for this block
+                for (size_t j = block * block_size; j < end; j++) { // For each acquisition sample in the block...
+                    draw_sample(dataset, stream, &acsamples[j * dim]);
+                }
+            }
+            for (size_t j = block * block_size; j < end; j++) { // For each acquisition sample in the block...
+                acscores[j] = acquisition(density, &acsamples[j * dim], scratch[thread]); // Calculate the acquisition function's value for the sample
+            }
+        });
+    }
+
+    // Propose a set of parameters from the fitted model, writing it to params - the acquisition sample with the best score
+    template <typename Release = NoRelease>
+    void propose(const TPETrialStore& dataset, TPEKernelDensity& density, ThreadPool& pool, uint64_t base_seed, uint64_t key, double* params, Stats* stats = nullptr) {
+        score<Release>(dataset, density, pool, base_seed, key, true, stats);
+        size_t bestSample = std::max_element(acscores.begin(), acscores.end()) - acscores.begin(); // Index of the sample with the best acquisition value
+        std::copy(sample(bestSample), sample(bestSample) + dim, params);
+    }
+
+    std::vector<double>& scores() { return acscores; } // Log of the acquisition function's value for each sample
+    const double* sample(size_t j) const { return &acsamples[j * dim]; } // Parameters of an acquisition sample
+
+    // Memoized weight denominators, by the size of the good set they were calculated for
+    std::vector<std::pair<int64_t, double>> denominators() const { return std::vector<std::pair<int64_t, double>>(denom_dict.begin(), denom_dict.end()); }
+    void restore_denominators(const std::vector<std::pair<int64_t, double>>& saved) {
+        for (const auto& entry : saved) { // For each denominator memoized by a saved run...
+            denom_dict[static_cast<int>(entry.first)] = entry.second;
+        }
+    }
+
+private:
+    // Fraction of the trials in the good set
+    double splitting(double group_size) const {
+        if (split < 0 || split > 1) { // If the split value is not within the range [0, 1] (eg. it isn't provided)...
+            return (threshold / std::sqrt(static_cast<double>(group_size))); // Return the threshold divided by the square root of the group size
+            // This calculation is based on the square root splitting algorithm used in Bergstra et al. 2013
+        }
+        return split;
+    }
+
+    // Denominator of the good candidates' weights, memoized by the size of the good set
+    double denominator_of(const TPETrialStore& dataset) {
+        auto found = denom_dict.find(static_cast<int>(good_size));
+        if (found != denom_dict.end()) { // If the denominator value is already in the memoization dictionary...
+            return found->second; // Return the value from the dictionary
+        }
+        double yq = dataset.value(good_size - 1); // Get the value of the last good candidate
+        double denominator = 0; // Initialize the denominator to zero
+        for (size_t j = 0; j < good_size; j++) { // For each good candidate...
+            denominator += (1.0 / (1.0 + good_size)) * (yq - dataset.value(j)); // Add on their denominator value
+        }
+        denom_dict[static_cast<int>(good_size)] = denominator; // Add the denominator value to the memoization dictionary
+        return denominator;
+    }
+
+    // Log of the non-informative prior for a set of parameters
+    double log_nIp(const double* params) const {
+        double runningSum = prior_log_norm; // Initialize the running sum to the log of the normalizer
+        for (size_t d = 0; d < dim; d++) { // For each dimension...
+            double diff = params[d] - prior_mean[d];
+            runningSum -= diff * diff * prior_inv_two_var[d]; // Add on the log of the Gaussian's exponent
+        }
+        return runningSum;
+    }
+
+    // Log of the acquisition function's value for a set of parameters
+    double acquisition(const TPEKernelDensity& density, const double* params, std::vector<double>& scratch) const {
+        double goodAcq, badAcq; // Log of the kernel density estimates for the good and bad candidates
+        density.evaluate(params, good_size, goodAcq, badAcq, scratch); // Calculate both kernel density estimates in a single pass over the centers
+        double p0 = log_w0 + log_nIp(params); // Calculate the log of the weighted non-informative prior for the parameters
+        return log_add_exp(goodAcq, p0) - log_add_exp(badAcq, p0); // Return the log of the acquisition function's value
+    }
+
+    // Draw an acquisition sample - uniformly over the search space, or from the mixture of the good candidates' kernels and the prior, each truncated to the search space
+    // Sampling where the good density is high, rather than uniformly, spends the acquisition samples where l(x) / g(x) can be large
+    // This is based on the sampling of candidates in Bergstra et al. 2011 and Watanabe 2023
+    void draw_sample(const TPETrialStore& dataset, std::mt19937_64& stream, double* params) const {
+        if (!mixture || !(mixture_cdf.back() > 0)) { // If the sample is drawn uniformly, or no component of the mixture has a usable weight...
+            for (size_t k = 0; k < dim; k++) { // For each dimension...
+                params[k] = std::uniform_real_distribution<double>(space_min[k], space_max[k])(stream); // Generate a random value within the search space
+            }
+            return;
+        }
+        std::normal_distribution<double> normal(0.0, 1.0); // Standard Gaussian, scaled per dimension
+        double u = std::uniform_real_distribution<double>(0.0, mixture_cdf.back())(stream); // Position within the cumulative weights
+        size_t component = std::min(static_cast<size_t>(std::upper_bound(mixture_cdf.begin(), mixture_cdf.end(), u) - mixture_cdf.begin()), good_size); // Component the sample is drawn from
+        for (size_t k = 0; k < dim; k++) { // For each dimension...
+            double mean = component < good_size ? dataset.row(component)[k] : prior_mean[k]; // Center of the component
+            double sigma = component < good_size ? kernel_bandwidth[k] : prior_sigma[k]; // Width of the component
+            params[k] = tpe_truncated_normal(stream, normal, mean, sigma, space_min[k], space_max[k]);
+        }
+    }
+
+    static constexpr size_t block_size = 64; // Number of acquisition samples drawn from each random number stream
+
+    std::vector<double> space_min, space_max; // Bounds of the search space
+    size_t dim; // Number of parameters
+    double threshold, split; // Settings of the splitting function
+    int group_cap; // Group cap for the good set
+    int prior_weight; // Prior weight parameter for Non-Informative Prior
+    bool mixture; // Whether acquisition samples are drawn from the good set's density
+    std::vector<double> prior_mean, prior_sigma; // Mean and standard deviation of the prior in each dimension
+    std::vector<double> prior_inv_two_var; // Cached 1 / (2 * sigma^2) for each dimension
+    double prior_log_norm; // Log of the prior's normalizer, scaled by the prior weight
+    std::unordered_map<int, double> denom_dict; // Memoization dictionary to hold denominator values in weight calculations
+
+    size_t good_size = 0, bad_size = 0; // Sizes of the good and bad sets of the last fit, the bad set counting fantasized observations
+    std::vector<double> kernel_bandwidth; // Bandwidth of the last fit
+    double log_w0 = 0; // Log of the weight of the zeroth basis of the last fit
+    std::vector<double> mixture_cdf; // Cumulative weight of each good candidate's kernel, then of the prior, when drawing from the good set's density
+    std::vector<double> acsamples; // Acquisition samples, one row per sample
+    std::vector<double> acscores; // Log of the acquisition function's value for each sample
+    std::vector<std::vector<double>> scratch; // Scratch buffer for the density estimate, one per thread
+};
+
+// Bayesian Optimization algorithm using Tree-structured Parzen Estimator (TPE) - returns the best parameters found
+// evaluate(points, n, dim, values) fills values[p] with the value of row p of the (n, dim) row-major points, to be *minimized*; the random initial samples
+// are evaluated in a single call, as is each iteration's batch - or, with parallel set, one point per call spread over the threads with a Release guard held
+template <typename Release = NoRelease, typename EvaluateBatch>
+std::vector<double> bayesopt_tpe(
+    EvaluateBatch&& evaluate, // Evaluates points - called as evaluate(const double* points, size_t n, size_t dim, double* values)
+    std::vector<double> space_min, // Lower bound vector for the search space
+    std::vector<double> space_max, // Upper bound vector for the search space
+    int iterations = 100, // Number of iterations to run the algorithm for
+    int samples = 10, // Number of samples to draw initially
+    int acquisition_samples = 100, // Number of samples to draw for acquisition function maximization
+    int verbose = 0, // Verbosity level - 1 outputs each evaluation and the best value
+    double threshold = 0.5, // Threshold value for the splitting function - unnecessary if split is provided
+    int group_cap = 9999, // Group cap for the good set
+    std::vector<double> bandwidth = std::vector<double>(), // Optional bandwidth vector for the KDE (overrides dynamic bandwidth calculation)
+    int prior_weight = 1, // Prior weight parameter for Non-Informative Prior
+    double split = -107.2931, // Optional splitting threshold (overrides dynamic threshold calculation)
+    const std::vector<std::pair<std::vector<double>, double>>& seed = std::vector<std::pair<std::vector<double>, double>>(), // Seed data for the algorithm
+    const std::string& kde = "exact", // Kernel density estimation method - "exact" sums every candidate, "tree" approximates large sets with KD-trees
+    double kde_tolerance = 1e-3, // Maximum relative error of each density when kde is "tree"
+    int n_threads = 1, // Number of threads used to generate and score acquisition samples, and to evaluate batches in parallel - 0 uses every hardware thread
+    long long rng_seed = -1, // Seed for the random number generator - negative for a nondeterministic seed
+    int batch_size = 1, // Number of points proposed and evaluated together each iteration
+    bool parallel = false, // Whether to evaluate the points of each batch in parallel threads - evaluate must then be thread-safe
+    Monitor* monitor = nullptr, // Collects stats and a record per evaluated point, or null
+    const Checkpoint* checkpoint = nullptr, // Where the trials are saved and resumed from, or null - a resumed run keeps the saved random number generator seed
+    TrialLog* log = nullptr, // Log every evaluation is appended to, and whose earlier trials are loaded as history unless the run is resumed, or null
+    const std::string& sampling = "uniform", // How acquisition samples are drawn - "uniform" over the search space, or "mixture" from the good set's density and the prior
+    Termination* termination = nullptr // Budgets and convergence tests checked after each iteration, which may end the run early, and the reason it ended, or null
+) {
+
+    // Check for invalid inputs
+    check_tpe_settings(space_min, space_max, iterations, samples, "samples", acquisition_samples, threshold, group_cap, bandwidth, split, kde, kde_tolerance, n_threads, sampling);
+    if (samples <= 0) { // If the number of samples is less than or equal to 0...
+        throw std::invalid_argument("Number of samples must be positive!"); // Throw an exception
+    }
+    if (batch_size <= 0) { // If the batch size is less than or equal to 0...
+        throw std::invalid_argument("Batch size must be positive!"); // Throw an exception
+    }
+    if (log != nullptr && log->dimension() != space_min.size()) { // If the log holds trials of another search space...
+        throw std::invalid_argument("Trial log must hold trials of the same size as the search space!"); // Throw an exception
+    }
+
+    bool dynam = bandwidth.size() != space_min.size(); // Whether the bandwidth is calculated from the number of trials
+    if (dynam) { // If the bandwidth vector is empty...
+        bandwidth = tpe_bandwidth(space_min, space_max, samples); // Calculate the initial bandwidth
+    }
+
+    uint64_t base_seed = run_seed(rng_seed); // Seed every random number stream is derived from
+    std::mt19937 rng(static_cast<std::mt19937::result_type>(mix_seed(base_seed))); // Initialize the random number generator for the initial samples
+    Stats* stats = stats_of(monitor); // Per-phase timers, or null
+    size_t dim = space_min.size(); // Number of parameters
+    ThreadPool pool(n_threads); // Threads used to generate and score the acquisition samples, and to evaluate batches in parallel
+
+    auto timed_evaluate = [&evaluate, stats, termination](const double* points, size_t n, size_t dim, double* values) { // Evaluate points, timing the call and counting the evaluations
+        PhaseTimer timer(stats, Phase::objective);
+        evaluate(points, n, dim, values);
+        if (stats != nullptr) {
+            stats->count_evaluations(n);
+        }
+        if (termination != nullptr) {
+            termination->count_evaluations(n);
+        }
+    };
+    auto evaluate_batch = [&](const double* points, size_t n, double* values) { // Evaluate n points - in a single call, or with parallel set, one point per call spread over the threads
+        if (parallel) { // If the points are evaluated in parallel...
+            Release release; // Let go of the caller's lock while the threads evaluate
+            pool.parallel_for(n, [&](size_t p, size_t) {
+                timed_evaluate(points + p * dim, 1, dim, values + p); // Evaluate the point
+            });
+        } else { // If not...
+            timed_evaluate(points, n, dim, values); // Evaluate every point in a single call
+        }
+    };
+    if (termination != nullptr) {
+        termination->start(false); // TPE minimizes
+        if (termination->measures_diversity()) { // If a spread was asked for, which a set of trials does not have...
+            throw std::invalid_argument("Diversity threshold requires a swarm or population!"); // Throw an exception
+        }
+    }
+
+    TPETrialStore dataset(space_min.size()); // Store of evaluated trials, sorted by value
+    dataset.reserve(samples + iterations + (log != nullptr ? log->loaded() : 0)); // Reserve space for every trial
+    TPEKernelDensity density(space_min.size(), kde == "tree", kde_tolerance); // Kernel density estimate over the dataset, kept in the same order
+    TPEModel model(space_min, space_max, threshold, split, group_cap, prior_weight, acquisition_samples, sampling == "mixture", pool.size()); // Weights and acquisition function fitted to the dataset
+
+    std::vector<std::uniform_real_distribution<double>> distributions; // Vector of uniform real distributions
+    for (size_t j = 0; j < space_min.size(); j++) { // For each dimension in the search space...
+        distributions.emplace_back(space_min[j], space_max[j]); // Add a uniform real distribution with the corresponding lower and upper bounds
+    }
+
+    double bestValue = std::numeric_limits<double>::max(); // Initialize the best value to the maximum double value
+    std::vector<double> bestParameters(space_min.size(), 0); // Initialize the best parameters to zeros
+
+    int start = 1; // First iteration to run
+    bool resumed = checkpoint != nullptr && checkpoint->resumable(); // Whether the trials are restored instead of sampled
+    if (resumed) { // If the trials were saved...
+        CheckpointReader in(checkpoint->path, "bayesopt_tpe");
+        start = in.read<int32_t>(); // First iteration left to run
+        CheckpointReader::expect<uint64_t>(in.read<uint64_t>(), space_min.size(), "number of parameters");
+        base_seed = in.read<uint64_t>(); // Keep the saved run's random number streams
+        in.read_random(rng);
+        std::vector<double> trial_params = in.read<std::vector<double>>(); // Parameters of every trial in insertion order
+        std::vector<double> trial_values = in.read<std::vector<double>>(); // Value of every trial in insertion order
+        in.read(bandwidth);
+        in.read(bestValue);
+        in.read(bestParameters);
+        model.restore_denominators(in.read<std::vector<std::pair<int64_t, double>>>()); // Keep the saved run's memoized weight denominators
+        if (trial_params.size() != trial_values.size() * space_min.size() || bandwidth.size() != space_min.size() || bestParameters.size() != space_min.size()) { // If the arrays do not fit the search space...
+            throw std::runtime_error("Checkpoint holds inconsistent trials!"); // Throw an exception
+        }
+        for (size_t t = 0; t < trial_values.size(); t++) { // For each trial, in the order it was added...
+            std::vector<double> parameters(trial_params.begin() + t * space_min.size(), trial_params.begin() + (t + 1) * space_min.size());
+            density.insert(dataset.add(parameters, trial_values[t]), parameters); // Add it back, rebuilding the same ranks and density estimate
+        }
+    }
+
+    size_t history = 0; // Number of trials loaded from the log
+    if (log != nullptr && !resumed) { // If there is history to load...
+        PhaseTimer timer(stats, Phase::kde);
+        std::vector<size_t> by_value(log->loaded()); // Trials of the log in order of value, so each is added at the end of the sorted dataset
+        std::iota(by_value.begin(), by_value.end(), 0);
+        std::stable_sort(by_value.begin(), by_value.end(), [log](size_t a, size_t b) { return log->value(a) < log->value(b); });
+        for (size_t t : by_value) { // For each trial in the log, best first...
+            if (log->value(t) < bestValue) { // If it is better than the best value...
+                bestValue = log->value(t); // Update the best value
+                bestParameters.assign(log->params(t), log->params(t) + space_min.size()); // Update the best parameters
+            }
+            density.insert(dataset.add(log->params(t), log->value(t)), log->params(t)); // Add a copy of it to the dataset
+        }
+        history = log->loaded();
+    }
+
+    if (!resumed) { // If the trials were not restored...
+        size_t seeded = log != nullptr ? seed.size() : std::min(static_cast<size_t>(samples), seed.size()); // Number of seed pairs added - every pair alongside a log's history, and at most samples otherwise
+        for (size_t i = 0; i < seeded; i++) { // For each sample within the seed data...
+            if (seed[i].first.size() != space_min.size()) { // If the seed parameters do not match the search space...
+                throw std::invalid_argument("Seed parameters must be of the same size as the search space!"); // Throw an exception
+            }
+            PhaseTimer timer(stats, Phase::kde);
+            density.insert(dataset.add(seed[i].first, seed[i].second), seed[i].first); // Add the seed data to the dataset
+        }
+
+        size_t known = history + seeded; // Number of initial samples already evaluated - the history and the seed count towards the initial samples
+        size_t draws = static_cast<size_t>(samples) > known ? static_cast<size_t>(samples) - known : 0; // Number of random initial samples
+        std::vector<double> initial(draws * dim); // Random initial samples, one row per sample
+        for (size_t p = 0; p < draws; p++) { // For each random sample...
+            for (size_t j = 0; j < dim; j++) { // For each dimension in the search space...
+                initial[p * dim + j] = distributions[j](rng); // Generate a random parameter value using the corresponding distribution
+            }
+        }
+        std::vector<double> initial_values(draws); // Value of each random sample
+        if (draws > 0) { // If there are samples to evaluate...
+            evaluate_batch(initial.data(), draws, initial_values.data()); // Evaluate them together, like an iteration's batch
+        }
+        for (size_t p = 0; p < draws; p++) { // For each random sample...
+            const double* parameters = &initial[p * dim]; // Parameters of the sample
+            double eval = initial_values[p]; // Value of the sample
+            if (log != nullptr) {
+                log->append(parameters, eval); // Record the evaluation
+            }
+            if (eval < bestValue) { // If the evaluation is better than the best value...
+                bestValue = eval; // Update the best value
+                bestParameters.assign(parameters, parameters + dim); // Update the best parameters
+            }
+            PhaseTimer timer(stats, Phase::kde);
+            density.insert(dataset.add(parameters, eval), parameters); // Add the generated parameters and evaluation to the dataset
+        }
+    }
+
+    for (int i = start; i < iterations; i++) { // For each iteration...
+
+        model.fit(dataset, density, bandwidth, stats); // Split the dataset into the good and bad sets, and weight their kernels
+
+        std::vector<size_t> picks; // Index of each acquisition sample picked for this iteration's batch
+        for (int b = 0; b < batch_size; b++) { // For each point in the batch...
+            if (b > 0) { // If a point has already been picked...
+                PhaseTimer timer(stats, Phase::kde);
+                model.fantasize(density, model.sample(picks.back())); // Pretend the last pick was observed with a bad value, so the next pick is pushed elsewhere
+            }
+            model.score<Release>(dataset, density, pool, base_seed, static_cast<uint64_t>(i), b == 0, stats); // Score the acquisition samples, drawn once for the whole batch
+            std::vector<double>& acscores = model.scores(); // Log of the acquisition function's value for each sample
+
+            for (size_t pick : picks) { // For each sample already in the batch...
+                acscores[pick] = -std::numeric_limits<double>::infinity(); // Keep the batch's points distinct
+            }
+
+            double bestAcq = -std::numeric_limits<double>::infinity(); // Initialize the best acquisition value to negative infinity
+            size_t bestSample = picks.empty() ? 0 : picks.back(); // Initialize the index of the best sample
+
+            for (size_t j = 0; j < acscores.size(); j++) { // For each acquisition sample...
+                if (acscores[j] > bestAcq) { // If the acquisition value is better than the best acquisition value...
+                    bestAcq = acscores[j]; // Update the best acquisition value
+                    bestSample = j; // Update the best sample (parameters)
+                }
+            }
+            if (bestAcq == -std::numeric_limits<double>::infinity() && !picks.empty()) { // If every sample has been picked...
+                break; // The batch cannot grow
+            }
+            picks.push_back(bestSample); // Add the best sample to the batch
+        }
+
+        if (picks.size() > 1) { // If there are fantasized observations...
+            PhaseTimer timer(stats, Phase::kde);
+            for (size_t b = 1; b < picks.size(); b++) { // For each fantasized observation...
+                density.erase(density.size() - 1); // Remove it from the density estimate
+            }
+        }
+
+        std::vector<double> evals(picks.size()); // Value of each point in the batch
+        std::vector<double> batch(picks.size() * dim); // Points of the batch, one row per point
+        for (size_t b = 0; b < picks.size(); b++) { // For each point in the batch...
+            std::copy(model.sample(picks[b]), model.sample(picks[b]) + dim, batch.begin() + b * dim); // Copy the point into its row
+        }
+        evaluate_batch(batch.data(), picks.size(), evals.data()); // Evaluate the whole batch
+
+        for (size_t b = 0; b < picks.size(); b++) { // For each point in the batch...
+            std::vector<double> newParameters(batch.begin() + b * dim, batch.begin() + (b + 1) * dim); // Parameters of the point
+            double eval = evals[b]; // Value of the point
+            if (log != nullptr) {
+                log->append(newParameters.data(), eval); // Record the evaluation
+            }
+            if (eval < bestValue) { // If the evaluation is better than the best value...
+                bestValue = eval; // Update the best value
+                bestParameters = newParameters; // Update the best parameters
+            }
+            size_t rank; // Rank of the new candidate
+            {
+                PhaseTimer timer(stats, Phase::sort);
+                rank = dataset.add(newParameters, eval); // Add the new candidate to the dataset
+            }
+            {
+                PhaseTimer timer(stats, Phase::kde);
+                density.insert(rank, newParameters); // Add only its center to the density estimate
+            }
+
+            if (monitor != nullptr && monitor->recording()) { // If the records replace the output...
+                monitor->record(i, bestValue, eval);
+            } else if (verbose == 1) { // If verbose output is enabled...
+                std::cout << "Iteration " << i << ": " << eval << std::endl; // Print the iteration number and evaluation
+                std::cout << "Best value: " << bestValue << std::endl; // Print the best value
+            }
+        }
+
+        if (dynam) { // If dynamic bandwidth is enabled...
+            bandwidth = tpe_bandwidth(space_min, space_max, dataset.size()); // Update the bandwidth
+        }
+
+        bool stopped = termination != nullptr && termination->stop(i + 1, bestValue); // Whether the run ends early, after i + 1 iterations counting the initial samples
+        if (checkpoint != nullptr && (checkpoint->due(i, i + 1) || i + 1 == iterations || stopped)) { // If a save is due or the run has ended - after i + 1 iterations, counting the initial samples
+            CheckpointWriter out("bayesopt_tpe");
+            out.write(static_cast<int32_t>(i + 1));
+            out.write(static_cast<uint64_t>(space_min.size()));
+            out.write(base_seed);
+            out.write_random(rng);
+            out.write(dataset.trial_params());
+            out.write(dataset.trial_values());
+            out.write(bandwidth);
+            out.write(bestValue);
+            out.write(bestParameters);
+            out.write(model.denominators());
+            out.commit(checkpoint->path);
+        }
+        if (stopped) {
+            break;
+        }
+    }
+
+    if (monitor != nullptr) {
+        monitor->flush(); // Pass on the remaining records
+    }
+    return bestParameters; // Return the best parameters
+}
+
+} // namespace quickopt
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define QUICKOPT_TRIAL_LOG_POSIX 1
+#endif
+
+namespace quickopt {
+
+// Append-only log of evaluated trials, read through a memory map - a study writes every evaluation to it, and later studies load it as history
+// The file is a 32-byte header - "QOTRIALS", the format version, a byte order mark and the number of parameters - followed by fixed-width records
+// of dim parameters and the value, all native-endian doubles; a record cut short by a crash is ignored, and overwritten by the next append
+// Records reach the file as each one is appended, so they survive the process dying; they are not flushed to disk, so a power loss may lose the last few
+class TrialLog {
+public:
+    // Open the log at path for trials of dim parameters, creating it if it does not exist
+    TrialLog(const std::string& path, size_t dim) : path(path), dim(dim) {
+#ifdef QUICKOPT_TRIAL_LOG_POSIX
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) { // If the file cannot be opened...
+            fail("Cannot open trial log");
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            fail("Cannot read trial log");
+        }
+        Header header{};
+        if (info.st_size == 0) { // If the log is new...
+            std::memcpy(header.magic, magic, sizeof(header.magic));
+            header.version = version;
+            header.byte_order = byte_order;
+            header.dim = dim;
+            if (::pwrite(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+                fail("Cannot write trial log");
+            }
+            info.st_size = sizeof(header);
+        } else if (info.st_size < static_cast<off_t>(sizeof(header)) || ::pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))
+                   || std::memcmp(header.magic, magic, sizeof(header.magic)) != 0) { // If it is not a trial log...
+            close_file();
+            throw std::runtime_error("\"" + path + "\" is not a trial log!"); // Throw an exception
+        } else if (header.version != version || header.byte_order != byte_order) { // If it was written by another version or on another machine...
+            close_file();
+            throw std::runtime_error("Trial log \"" + path + "\" was written by an incompatible version or machine!"); // Throw an exception
+        } else if (header.dim != dim) { // If its trials have another number of parameters...
+            close_file();
+            throw std::invalid_argument("Trial log \"" + path + "\" holds trials of " + std::to_string(header.dim) + " parameters, not " + std::to_string(dim) + "!"); // Throw an exception
+        }
+
+        count = (static_cast<size_t>(info.st_size) - sizeof(header)) / record_size(); // Number of complete records
+        if (count > 0) { // If there are records to read...
+            mapped_size = sizeof(header) + count * record_size();
+            void* at = ::mmap(nullptr, mapped_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (at == MAP_FAILED) {
+                fail("Cannot map trial log");
+            }
+            mapped = static_cast<const char*>(at);
+        }
+#else
+        throw std::runtime_error("Trial logs require a POSIX system!"); // Throw an exception
+#endif
+    }
+
+    ~TrialLog() {
+        unmap();
+        close_file();
+    }
+
+    TrialLog(const TrialLog&) = delete;
+    TrialLog& operator=(const TrialLog&) = delete;
+
+    size_t dimension() const { return dim; } // Number of parameters per trial
+    size_t loaded() const { return count; } // Number of trials in the log when it was opened, which are readable in place
+    size_t appended() const { return written; } // Number of trials appended since it was opened
+
+    // Parameters and value of a trial that was in the log when it was opened - read in place from the mapping, without copying
+    const double* params(size_t i) const { return reinterpret_cast<const double*>(mapped + sizeof(Header) + i * record_size()); }
+    double value(size_t i) const { return params(i)[dim]; }
+
+    // Append a trial - each record is written with a single call at its own offset, so a crash leaves at most one partial record at the end
+    void append(const double* trial, double trial_value) {
+#ifdef QUICKOPT_TRIAL_LOG_POSIX
+        record.assign(trial, trial + dim);
+        record.push_back(trial_value);
+        off_t offset = static_cast<off_t>(sizeof(Header) + (count + written) * record_size()); // Offset of the record, past any partial one
+        const char* bytes = reinterpret_cast<const char*>(record.data());
+        size_t left = record_size();
+        while (left > 0) { // Until the whole record is written...
+            ssize_t n = ::pwrite(fd, bytes, left, offset);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                throw std::runtime_error("Cannot append to trial log \"" + path + "\"!"); // Throw an exception
+            }
+            bytes += n;
+            offset += n;
+            left -= static_cast<size_t>(n);
+        }
+        written++;
+#endif
+    }
+
+private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byte_order;
+        uint64_t dim;
+        uint64_t reserved;
+    };
+    static_assert(sizeof(Header) == 32, "trial log header must be 32 bytes");
+    static constexpr const char* magic = "QOTRIALS"; // First bytes of every trial log
+    static const uint32_t version = 1; // Format version
+    static const uint32_t byte_order = 0x01020304; // Byte order mark
+
+    size_t record_size() const { return (dim + 1) * sizeof(double); } // Bytes per trial
+
+    // Close the file and throw an exception naming the failed operation
+    [[noreturn]] void fail(const char* what) {
+        std::string reason = std::strerror(errno);
+        close_file();
+        throw std::runtime_error(std::string(what) + " \"" + path + "\": " + reason + "!"); // Throw an exception
+    }
+
+    void unmap() {
+#ifdef QUICKOPT_TRIAL_LOG_POSIX
+        if (mapped != nullptr) {
+            ::munmap(const_cast<char*>(mapped), mapped_size);
+            mapped = nullptr;
+        }
+#endif
+    }
+
+    void close_file() {
+#ifdef QUICKOPT_TRIAL_LOG_POSIX
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+#endif
+    }
+
+    std::string path; // Path of the log
+    size_t dim; // Number of parameters per trial
+    int fd = -1; // Open file
+    const char* mapped = nullptr; // Mapping of the header and the records present when the log was opened
+    size_t mapped_size = 0; // Size of the mapping
+    size_t count = 0; // Number of records present when the log was opened
+    size_t written = 0; // Number of records appended since
+    std::vector<double> record; // Scratch buffer of the record being appended
+};
+
+} // namespace quickopt
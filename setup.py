@@ -21,6 +21,7 @@ ext_modules = [
         include_dirs=[
             get_pybind_include(),
             get_pybind_include(user=True),
+            'include',
         ],
         language='c++',
         extra_compile_args=['-std=c++17'],
@@ -31,8 +32,9 @@ ext_modules = [
         include_dirs=[
             get_pybind_include(),
             get_pybind_include(user=True),
+            'include',
         ],
-        depends=['src/common.cpp'],
+        depends=['src/checkpoint.h', 'src/common.cpp', 'src/monitor.h', 'src/numpy_view.h', 'src/objective.h', 'src/termination.h', 'src/operator_params.h', 'include/quickopt/alphabet.hpp', 'include/quickopt/annealing.hpp', 'include/quickopt/checkpoint.hpp', 'include/quickopt/eval_cache.hpp', 'include/quickopt/random.hpp', 'include/quickopt/stats.hpp', 'include/quickopt/termination.hpp', 'include/quickopt/thread_pool.hpp'],
         language='c++',
         extra_compile_args=['-std=c++17'],
     ),
@@ -42,8 +44,9 @@ ext_modules = [
         include_dirs=[
             get_pybind_include(),
             get_pybind_include(user=True),
+            'include',
         ],
-        depends=['src/common.cpp'],
+        depends=['src/checkpoint.h', 'src/common.cpp', 'src/monitor.h', 'src/numpy_view.h', 'src/objective.h', 'src/termination.h', 'include/quickopt/bohb.hpp', 'include/quickopt/checkpoint.hpp', 'include/quickopt/random.hpp', 'include/quickopt/stats.hpp', 'include/quickopt/termination.hpp', 'include/quickopt/thread_pool.hpp', 'include/quickopt/tpe.hpp', 'include/quickopt/trial_log.hpp'],
         language='c++',
         extra_compile_args=['-std=c++17'],
     ),
@@ -53,8 +56,9 @@ ext_modules = [
         include_dirs=[
             get_pybind_include(),
             get_pybind_include(user=True),
+            'include',
         ],
-        depends=['src/common.cpp'],
+        depends=['src/checkpoint.h', 'src/common.cpp', 'src/monitor.h', 'src/numpy_view.h', 'src/objective.h', 'src/termination.h', 'src/operator_params.h', 'src/process_pool.h', 'include/quickopt/alphabet.hpp', 'include/quickopt/checkpoint.hpp', 'include/quickopt/eval_cache.hpp', 'include/quickopt/genetic.hpp', 'include/quickopt/random.hpp', 'include/quickopt/stats.hpp', 'include/quickopt/termination.hpp', 'include/quickopt/thread_pool.hpp'],
         language='c++',
         extra_compile_args=['-std=c++17'],
     ),
@@ -64,8 +68,9 @@ ext_modules = [
         include_dirs=[
             get_pybind_include(),
             get_pybind_include(user=True),
+            'include',
         ],
-        depends=['src/common.cpp'],
+        depends=['src/checkpoint.h', 'src/common.cpp', 'src/monitor.h', 'src/numpy_view.h', 'src/objective.h', 'src/termination.h', 'src/process_pool.h', 'include/quickopt/checkpoint.hpp', 'include/quickopt/pso.hpp', 'include/quickopt/random.hpp', 'include/quickopt/stats.hpp', 'include/quickopt/termination.hpp', 'include/quickopt/thread_pool.hpp'],
         language='c++',
         extra_compile_args=['-std=c++17'],
     )
@@ -82,6 +87,7 @@ setup(
     ext_modules=ext_modules,
     install_requires=[
         'pybind11>=2.5.0',
+        'numpy',
     ],
     cmdclass={'build_ext': build_ext},
     zip_safe=False,
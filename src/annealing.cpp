@@ -7,82 +7,392 @@
 #include <stdexcept>
 #include <vector>
 #include <sstream>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <atomic>
+#include <memory>
+#include "quickopt/annealing.hpp"
+#include "quickopt/eval_cache.hpp"
+#include "checkpoint.h"
+#include "monitor.h"
+#include "numpy_view.h"
+#include "objective.h"
+#include "operator_params.h"
+#include "termination.h"
 
 namespace py = pybind11;
 
+using quickopt::AnnealChain;
+using quickopt::AnnealOperators;
+using quickopt::Candidate;
+using quickopt::EvalCache;
+using quickopt::Phase;
+using quickopt::PhaseTimer;
+
+// Select the annealing operators from Python arguments - each is a Python function or the name of a built-in operator configured by its dict
+// horizon is the number of iterations of the run, the default steps of "linear" and "lam", or 0 if it is not known
+template <typename T>
+AnnealOperators<T> anneal_operators(py::object neighbor, py::object temperature, py::object acceptance, const py::dict& neighbor_params, const py::dict& temperature_params, int horizon) {
+    using Operators = AnnealOperators<T>;
+    Operators operators; // Selected operators
+    // Select the temperature schedule
+    if (!py::isinstance<py::str>(temperature)) { // If the schedule is a Python function...
+        operators.schedule = Operators::Schedule::custom;
+        operators.custom_temperature = [temperature](int iter) {
+            py::gil_scoped_acquire acquire; // Chains may run without the GIL
+            return temperature(iter).template cast<double>();
+        };
+        OperatorParams("schedule", "function", temperature_params).finish(); // It takes no parameters
+    } else {
+        std::string name = temperature.cast<std::string>();
+        OperatorParams tp("schedule", name, temperature_params);
+        operators.t0 = tp.number("t0", 1.0); // Initial temperature
+        if (name == "geometric") {
+            operators.schedule = Operators::Schedule::geometric;
+            operators.alpha = tp.number("alpha", 0.999); // Cooling factor per iteration
+            if (operators.alpha <= 0 || operators.alpha > 1) { // If the factor does not cool...
+                throw std::invalid_argument("alpha must fall within (0, 1]!"); // Throw an exception
+            }
+        } else if (name == "linear" || name == "lam") {
+            operators.schedule = name == "linear" ? Operators::Schedule::linear : Operators::Schedule::lam;
+            if (operators.schedule == Operators::Schedule::linear) {
+                operators.t_min = tp.number("t_min", 1e-3); // Final temperature
+                if (operators.t_min <= 0 || operators.t_min > operators.t0) { // If the final temperature is not within (0, t0]...
+                    throw std::invalid_argument("t_min must fall within (0, t0]!"); // Throw an exception
+                }
+            }
+            operators.steps = static_cast<int>(tp.number("steps", horizon)); // Number of iterations the schedule spans
+            if (operators.steps < 1) { // If the span is unknown...
+                throw std::invalid_argument("Schedule \"" + name + "\" requires steps!"); // Throw an exception
+            }
+        } else if (name == "logarithmic") {
+            operators.schedule = Operators::Schedule::logarithmic;
+        } else {
+            throw std::invalid_argument("Unknown schedule \"" + name + "\"!"); // Throw an exception
+        }
+        if (operators.t0 <= 0) { // If the initial temperature is not positive...
+            throw std::invalid_argument("t0 must be positive!"); // Throw an exception
+        }
+        tp.finish();
+    }
+
+    // Select the acceptance rule
+    if (!py::isinstance<py::str>(acceptance)) { // If the rule is a Python function...
+        operators.rule = Operators::Acceptance::custom;
+        operators.custom_acceptance = [acceptance](double new_value, double current_value, double temperature) {
+            py::gil_scoped_acquire acquire; // Chains may run without the GIL
+            return acceptance(new_value, current_value, temperature).template cast<double>();
+        };
+    } else if (acceptance.cast<std::string>() == "metropolis") {
+        operators.rule = Operators::Acceptance::metropolis;
+    } else {
+        throw std::invalid_argument("Unknown acceptance \"" + acceptance.cast<std::string>() + "\"!"); // Throw an exception
+    }
+
+    // Select the neighbor generator
+    if (!py::isinstance<py::str>(neighbor)) { // If the generator is a Python function...
+        operators.move = Operators::Neighbor::custom;
+        operators.custom_neighbor = [neighbor](const std::vector<T>& params) {
+            py::gil_scoped_acquire acquire; // Chains may run without the GIL
+            return neighbor(params).template cast<std::vector<T>>();
+        };
+        OperatorParams("neighbor", "function", neighbor_params).finish(); // It takes no parameters
+        return operators;
+    }
+    std::string name = neighbor.cast<std::string>();
+    OperatorParams np("neighbor", name, neighbor_params);
+    if (name == "gaussian") {
+        if (!std::is_same<T, double>::value) { // If the parameters are not doubles...
+            throw std::invalid_argument("Neighbor \"gaussian\" only supports double parameters!"); // Throw an exception
+        }
+        operators.move = Operators::Neighbor::gaussian;
+        operators.sigma = np.number("sigma", 0.1); // Standard deviation of each step
+    } else if (name == "integer_step") {
+        if (!std::is_integral<T>::value) { // If the parameters are not integers...
+            throw std::invalid_argument("Neighbor \"integer_step\" only supports integer parameters!"); // Throw an exception
+        }
+        operators.move = Operators::Neighbor::integer_step;
+        operators.step_size = static_cast<int>(np.number("step", 1)); // Largest step
+        if (operators.step_size < 1) { // If there is no step...
+            throw std::invalid_argument("step must be at least 1!"); // Throw an exception
+        }
+    } else if (name == "string_edit") {
+        if (!std::is_same<T, std::string>::value) { // If the parameters are not strings...
+            throw std::invalid_argument("Neighbor \"string_edit\" only supports string parameters!"); // Throw an exception
+        }
+        operators.move = Operators::Neighbor::string_edit;
+        operators.alphabet = np.text("alphabet", printable_ascii()); // Characters substituted and inserted
+        if (operators.alphabet.empty()) { // If there is nothing to insert...
+            throw std::invalid_argument("Alphabet must not be empty!"); // Throw an exception
+        }
+    } else {
+        throw std::invalid_argument("Unknown neighbor \"" + name + "\"!"); // Throw an exception
+    }
+    if (operators.move != Operators::Neighbor::string_edit) { // Numeric steps may be clamped
+        operators.low = np.number("low", std::numeric_limits<double>::lowest()); // Lowest value of a parameter
+        operators.high = np.number("high", std::numeric_limits<double>::max()); // Highest value of a parameter
+        if (operators.low > operators.high) { // If the bounds are inverted...
+            throw std::invalid_argument("low must not exceed high!"); // Throw an exception
+        }
+    }
+    np.finish();
+    return operators;
+}
+
 // Modular simulated annealing algorithm
 template <typename T>
-std::vector<T> anneal(
-    py::function funct, // The function to be minimized
+py::object anneal(
+    py::object funct, // The function to be minimized - a Python function, or a native objective for doubles
     std::vector<T> initial, // Initial guess - the starting set of parameters for simulated annealing process
-    py::function neighbor,  // Neighbor function - generates a new set of parameters based on the current set
+    py::object neighbor,  // Neighbor function - generates a new set of parameters based on the current set, or the name of a built-in generator
     int iterations = 100,  // Number of iterations to run the algorithm for
-    py::function temperature = py::cpp_function([](int iter) { return pow(0.999, iter); }), // Temperature schedule - determines the temperature at each iteration
-    py::function acceptance = py::cpp_function([](double new_value, double current_value, double temperature) {
-        
-        if (temperature > 1 || temperature <= 0){
-        std::cerr << "Warning: Temperature outside (0,1], temperature scheduling likely incorrect! Current temperature: " << temperature << std::endl;
-    }
-    if (new_value < current_value){
-        return 1.0;
-    }
-    double probability = exp(-(new_value - current_value) / temperature); // Calculate the acceptance probability
-    return probability;
-}), // Acceptance probability - determines whether to accept a new set of parameters based on the current set and temperature
-    int verbose = 1 // Verbosity level - 0 for final output, 1 for output at each iteration
+    py::object temperature = py::str("geometric"), // Temperature schedule - determines the temperature at each iteration, a Python function or the name of a built-in schedule
+    py::object acceptance = py::str("metropolis"), // Acceptance probability - determines whether to accept a new set of parameters based on the current set and temperature, a Python function or "metropolis"
+    int verbose = 1, // Verbosity level - 0 for final output, 1 for output at each iteration
+    double cache_mb = 0, // Memory cap of the value cache in megabytes - 0 disables it
+    bool full_output = false, // Whether to also return a dict of run information
+    int replicas = 1, // Number of chains for replica exchange - 1 runs a single annealed chain
+    std::vector<double> ladder = {}, // Temperature of each replica - empty spaces them geometrically between temperature(0) and temperature(iterations)
+    int swap_interval = 10, // Number of iterations between exchanges of adjacent replicas
+    py::dict neighbor_params = py::dict(), // Parameters of a built-in neighbor generator
+    py::dict temperature_params = py::dict(), // Parameters of a built-in temperature schedule
+    py::object callback = py::none(), // Function receiving lists of per-iteration records in place of the per-iteration output
+    int callback_every = 1, // Number of iterations between calls to the callback
+    std::string checkpoint = "", // File the state of the run is saved to - empty for none
+    int checkpoint_every = 10, // Number of iterations between saves
+    bool resume = false, // Whether to continue the run saved in checkpoint, if the file exists
+    long long max_evaluations = 0, // Number of evaluations after which the run stops - 0 for no limit
+    double max_time = 0, // Number of seconds after which the run stops - 0 for no limit
+    py::object target = py::none(), // Best value at which the run stops - None for none
+    int patience = 0, // Number of iterations without improvement after which the run stops - 0 to never stop
+    double tolerance = 0, // Smallest improvement of the best value that resets the patience
+    bool batch = false // Batch mode - if true, funct takes the proposals of every replica at once and returns an array of values
 ) {
 
+    NativeObjective native; // Native objective, if funct is one
+    bool is_native = native_objective(funct, native); // Whether funct is a native objective
 
-    // Candidate class to store parameters that have been accepted as well as their values
-    class Candidate {
-    public:
-        std::vector<T> params; // Parameters for each candidate solution
-        double value; // Value of each candidate solution
-        
-        Candidate(const std::vector<T>& p, double v) : params(p), value(v) {}
-    };
+    // Check for invalid inputs
+    if (is_native && !std::is_same<T, double>::value) { // If a native objective was given for non-double parameters...
+        throw std::invalid_argument("Native objectives only support double parameters!"); // Throw an exception
+    }
+    if (is_native && batch) { // If a native objective was given in batch mode...
+        throw std::invalid_argument("Batch mode requires a Python function!"); // Throw an exception
+    }
+    if (cache_mb < 0) { // If the cache size is negative...
+        throw std::invalid_argument("Cache size must be non-negative!"); // Throw an exception
+    }
+    if (replicas < 1) { // If there are no replicas...
+        throw std::invalid_argument("Number of replicas must be at least 1!"); // Throw an exception
+    }
+    if (!ladder.empty() && ladder.size() != static_cast<size_t>(replicas)) { // If the ladder does not match the replicas...
+        throw std::invalid_argument("Ladder must hold one temperature per replica!"); // Throw an exception
+    }
+    if (swap_interval < 1) { // If the swap interval is not positive...
+        throw std::invalid_argument("Swap interval must be at least 1!"); // Throw an exception
+    }
 
-    double iv = funct(initial).template cast<double>(); // Calculate the value of the initial guess
-    Candidate current(initial, iv); // Create the current candidate variable, to store the current accepted guess, and set it as the initial guess provided
-    Candidate best(initial, iv); // Create the best candidate variable, to store our best guess, and set it as the initial guess provided
+    AnnealOperators<T> operators = anneal_operators<T>(neighbor, temperature, acceptance, neighbor_params, temperature_params, iterations); // Schedule, acceptance rule and neighbor generator
 
-    double temp = temperature(0).template cast<double>(); // Initial temperature
-    std::mt19937 rng(std::random_device{}()); // Random number generator
-    std::uniform_real_distribution<> dist(0.0, 1.0); // Uniform distribution for acceptance probability
+    EvalCache<T> cache(static_cast<size_t>(cache_mb * 1024 * 1024)); // Cache of values of revisited parameters
+    std::atomic<size_t> evaluations{0}; // Number of function evaluations
+    quickopt::Monitor monitor; // Stats and records of the run
+    quickopt::Monitor* observer = python_monitor(monitor, full_output, callback, callback_every); // Monitor passed to the engine, or null
+    quickopt::Stats* stats = quickopt::stats_of(observer); // Per-phase timers, or null
+    quickopt::Checkpoint saves; // Where and how often the run is saved
+    const quickopt::Checkpoint* saved = python_checkpoint(saves, checkpoint, checkpoint_every, resume); // Checkpoint passed to the engine, or null
+    quickopt::Termination stopping; // Budgets and convergence tests of the run
+    quickopt::Termination* stop = python_termination(stopping, max_evaluations, max_time, target, patience, tolerance); // Termination tests passed to the engine, or null
 
-    // For every iteration...
-    for (int iter = 0; iter < iterations; ++iter) {
-        double new_temp = temperature(iter).template cast<double>(); // Calculate the temperature for the current iteration
-        if (new_temp > temp) {
-            std::cerr << "Warning: Temperature must be decreasing. Current temperature: " << new_temp << " Previous temperature: " << temp << std::endl;
+    // Call the Python function on parameters converted by to_python, timing the conversions - the GIL must be held
+    auto call_python = [&](auto to_python, const T* params, size_t n) {
+        py::object converted; // Parameters as passed to the function
+        {
+            PhaseTimer timer(stats, Phase::marshalling);
+            converted = py::cast(to_python(params, n));
         }
-        temp = new_temp; // Update the temperature
+        py::object returned = funct(converted);
+        PhaseTimer timer(stats, Phase::marshalling);
+        return returned.template cast<double>();
+    };
 
-        std::vector<T> new_params = neighbor(current.params).template cast<std::vector<T>>(); // Generate a new set of parameters based on the current set
-        double new_val = funct(new_params).template cast<double>(); // Calculate the value of the new set of parameters
+    // Calculate the value of a set of parameters, unless it is cached - may be called from replica threads without the GIL
+    auto evaluate = [&](const T* params, size_t n) {
+        double value;
+        if (!cache.lookup(params, n, value)) { // If the value is not cached...
+            if constexpr (std::is_same<T, double>::value) {
+                if (is_native) { // If the objective is native...
+                    value = native(params, n); // Calculate it without the GIL
+                } else {
+                    py::gil_scoped_acquire acquire;
+                    value = call_python([](const double* params, size_t n) { return readonly_view(params, n); }, params, n); // Calculate it, passing a view of the parameters
+                }
+            } else {
+                py::gil_scoped_acquire acquire;
+                value = call_python([](const T* params, size_t n) { return std::vector<T>(params, params + n); }, params, n); // Calculate it
+            }
+            evaluations++;
+            cache.insert(params, n, value); // And cache it
+        }
+        return value;
+    };
 
-        if (new_val < best.value) { // If the new set of parameters is better than the best set of parameters...
-            best = Candidate(new_params, new_val); // Set the new set of parameters as the best candidate
+    // Calculate the values of count row-major sets of n parameters, looking each up in the cache first
+    // In batch mode, the sets not cached are passed to funct in a single call, as a (count, n) array for doubles and a list of lists otherwise
+    auto evaluate_batch = [&](const T* points, size_t count, size_t n, double* values) {
+        if (!batch) { // If funct takes one set at a time...
+            for (size_t p = 0; p < count; ++p) { // For each set...
+                values[p] = evaluate(points + p * n, n);
+            }
+            return;
+        }
+        std::vector<size_t> misses; // Sets whose values are not cached
+        for (size_t p = 0; p < count; ++p) { // For each set...
+            if (!cache.lookup(points + p * n, n, values[p])) { // If its value is not cached...
+                misses.push_back(p);
+            }
+        }
+        if (misses.empty()) { // If every value was cached...
+            return;
+        }
+        py::gil_scoped_acquire acquire;
+        std::vector<T> rows; // Sets not cached, one row per set
+        rows.reserve(misses.size() * n);
+        for (size_t p : misses) { // For each set not cached...
+            rows.insert(rows.end(), points + p * n, points + (p + 1) * n);
+        }
+        py::object converted; // Sets as passed to the function
+        {
+            PhaseTimer timer(stats, Phase::marshalling);
+            if constexpr (std::is_same<T, double>::value) {
+                converted = owning_view(std::move(rows), misses.size(), n); // Hand the sets over without copying them, so the array outlives the call
+            } else {
+                std::vector<std::vector<T>> lists; // Sets as lists
+                for (size_t m = 0; m < misses.size(); ++m) { // For each set not cached...
+                    lists.emplace_back(rows.begin() + m * n, rows.begin() + (m + 1) * n);
+                }
+                converted = py::cast(lists);
+            }
         }
+        py::object returned = funct(converted); // Evaluate every set not cached in a single call
+        PhaseTimer timer(stats, Phase::marshalling);
+        auto result = returned.template cast<py::array_t<double, py::array::c_style | py::array::forcecast>>(); // Convert the result to a contiguous array of doubles
+        if (result.size() != static_cast<py::ssize_t>(misses.size())) { // If there is not one value per set...
+            throw std::invalid_argument("Batch function must return one value per set of parameters!"); // Throw an exception
+        }
+        for (size_t m = 0; m < misses.size(); ++m) { // For each set not cached...
+            values[misses[m]] = result.data()[m];
+            cache.insert(points + misses[m] * n, n, values[misses[m]]); // Cache its value
+        }
+        evaluations += misses.size();
+    };
 
-        if (verbose == 1) {
-            std::cout << "Iteration: " << iter << " Best value: " << best.value << std::endl; // Output the iteration number and the best value
-            std::cout << "Current value: " << current.value << std::endl; // Output the current value
-            std::cout << "Best value: " << best.value << std::endl; // Output the best value
+    // Return the best parameters, with the run information if it was asked for
+    auto result = [&](const std::vector<T>& best_params, py::dict info) -> py::object {
+        if (!full_output) { // If only the parameters were asked for...
+            return result_params(best_params); // Return the best parameters
         }
+        info["evaluations"] = evaluations.load(); // Number of function evaluations
+        info["cache_hits"] = cache.hits(); // Number of values found in the cache
+        info["cache_misses"] = cache.misses(); // Number of values not found in the cache
+        info["stats"] = stats_dict(monitor.stats); // Time spent in each phase, and the number of calls to the engine's objective, cached or not
+        info["stop_reason"] = quickopt::stop_reason_name(stopping.reason()); // Criterion that ended the run
+        return py::make_tuple(result_params(best_params), info); // Return the best parameters and the run information
+    };
 
-        double prob = acceptance(new_val, current.value, temp).template cast<double>();
-        if (prob < 0.0 || prob > 1.0) { // If the acceptance probability is not within 0 and 1..
-            throw std::invalid_argument("Acceptance probability must fall between 0 and 1!"); // Throw an exception
+    if (replicas > 1) { // If replica exchange was requested...
+        if (ladder.empty()) { // If no ladder was given, space the temperatures geometrically from the hottest to the coldest of the schedule
+            ladder = quickopt::default_ladder(operators, replicas, iterations);
         }
+        for (double t : ladder) { // For each temperature...
+            if (!(t > 0)) { // If it is not positive...
+                throw std::invalid_argument("Ladder temperatures must be positive!"); // Throw an exception
+            }
+        }
+
+        size_t swap_attempts = 0, swaps = 0; // Number of exchanges offered and accepted
+        Candidate<T> best = quickopt::temper<py::gil_scoped_release>(evaluate_batch, is_native, initial, operators, ladder, iterations, swap_interval, verbose, swap_attempts, swaps, observer, saved, stop); // Step the chains in parallel only for native objectives
+        py::dict info; // Run information
+        info["swap_attempts"] = swap_attempts; // Number of exchanges offered
+        info["swaps"] = swaps; // Number of exchanges accepted
+        return result(best.params, info);
+    }
 
-        if (dist(rng) < prob) { // If the new set of parameters is accepted...
-            current = Candidate(new_params, new_val); // Set the new set of parameters as the current set
+    Candidate<T> best = quickopt::anneal([&](const T* params, size_t n) { // Anneal a single chain, as a batch of one in batch mode
+        double value;
+        evaluate_batch(params, 1, n, &value);
+        return value;
+    }, initial, operators, iterations, verbose, observer, saved, stop);
+    return result(best.params, py::dict());
+}
+
+// Ask/tell interface to simulated annealing - the caller evaluates each proposal, so evaluations can be scheduled however it likes
+// The first ask() returns the initial guess, and every later ask() returns a neighbor of the current candidate
+template <typename T>
+class AnnealState {
+public:
+    AnnealState(std::vector<T> initial, py::object neighbor, py::object temperature, py::object acceptance, py::dict neighbor_params, py::dict temperature_params)
+        : operators(anneal_operators<T>(neighbor, temperature, acceptance, neighbor_params, temperature_params, 0)), chain(initial, operators, quickopt::run_seed(-1)), proposal(initial) {}
+
+    // Return the parameters waiting to be evaluated - proposes a new set if the last one was told
+    std::vector<T> ask() {
+        if (!pending) { // If the last proposal has been evaluated...
+            if (started) { // If the initial guess has been evaluated...
+                proposal = chain.propose(iteration); // Generate a new set of parameters based on the current set
+            }
+            pending = true; // The proposal is now waiting for its value
         }
+        return proposal; // Return the proposal
     }
 
-    std::cout << "Best value: " << best.value << std::endl;
-    return best.params; // Return the best parameters
+    // Record the value of the parameters returned by the last ask()
+    void tell(double value) {
+        if (!pending) { // If there is nothing waiting to be evaluated...
+            throw std::logic_error("tell() must follow ask()!"); // Throw an exception
+        }
+        if (started) { // If this was a proposal...
+            chain.step(proposal, value); // Update the best candidate and decide whether to accept the proposal
+            iteration++; // Count the iteration
+        } else { // If this was the initial guess...
+            chain.start(value); // Record its value
+            started = true;
+        }
+        pending = false; // Nothing is waiting for a value
+    }
+
+    py::object best_params() const { return result_params(chain.best.params); } // Best parameters so far
+    double best_value() const { return chain.best.value; } // Best value so far
+    const std::vector<T>& current_params() const { return chain.current.params; } // Current accepted parameters
+    int iterations() const { return iteration; } // Number of completed iterations, not counting the initial guess
+
+private:
+    AnnealOperators<T> operators; // Schedule, acceptance rule and neighbor generator - declared before the chain that refers to them
+    AnnealChain<T> chain; // Chain being annealed
+    std::vector<T> proposal; // Parameters waiting to be evaluated
+    bool started = false; // Whether the initial guess has been evaluated
+    bool pending = false; // Whether a proposal is waiting for its value
+    int iteration = 0; // Number of completed iterations
+};
+
+// Define an ask/tell optimizer state for a given parameter type
+template <typename T>
+void define_anneal_state(py::module_& m, const char* name, const char* doc) {
+    py::class_<AnnealState<T>>(m, name, doc)
+        .def(py::init<std::vector<T>, py::object, py::object, py::object, py::dict, py::dict>(),
+            py::arg("initial"), // Define the initial parameters
+            py::arg("neighbor"), // Define the neighbor generation function or built-in generator
+            py::arg("temperature") = "geometric", // Define the temperature schedule with a default value of "geometric"
+            py::arg("acceptance") = "metropolis", // Define the acceptance probability with a default value of "metropolis"
+            py::arg("neighbor_params") = py::dict(), // Define the neighbor generator parameters with a default value of {}
+            py::arg("temperature_params") = py::dict() // Define the temperature schedule parameters with a default value of {}
+        )
+        .def("ask", &AnnealState<T>::ask, "Returns the parameters waiting to be evaluated")
+        .def("tell", &AnnealState<T>::tell, py::arg("value"), "Records the value of the parameters returned by the last ask()")
+        .def_property_readonly("best_params", &AnnealState<T>::best_params) // Define the best parameters so far
+        .def_property_readonly("best_value", &AnnealState<T>::best_value) // Define the best value so far
+        .def_property_readonly("current_params", &AnnealState<T>::current_params) // Define the current accepted parameters
+        .def_property_readonly("iterations", &AnnealState<T>::iterations); // Define the number of completed iterations
 }
 
 PYBIND11_MODULE(annealing, m) { // Define the Python module
@@ -90,21 +400,29 @@ PYBIND11_MODULE(annealing, m) { // Define the Python module
     m.def("anneal_double", &anneal<double>,
         py::arg("funct"), // Define the function to be minimized
         py::arg("initial"), // Define the initial parameters
-        py::arg("neighbor"), // Define the neighbor generation function
+        py::arg("neighbor"), // Define the neighbor generation function or built-in generator
         py::arg("iterations") = 100, // Define the number of iterations
-        py::arg("temperature") = py::cpp_function([](int iter) { return pow(0.999, iter); }), // Define the temperature schedule function with a default value
-        py::arg("acceptance") = py::cpp_function([](double new_value, double current_value, double temperature) {
-        
-        if (temperature > 1 || temperature <= 0){
-        std::cerr << "Warning: Temperature outside (0,1], temperature scheduling likely incorrect! Current temperature: " << temperature << std::endl;
-    }
-    if (new_value < current_value){
-        return 1.0;
-    }
-    double probability = exp(-(new_value - current_value) / temperature); // Calculate the acceptance probability
-    return probability;
-}), // Define the acceptance probability function
+        py::arg("temperature") = "geometric", // Define the temperature schedule with a default value of "geometric"
+        py::arg("acceptance") = "metropolis", // Define the acceptance probability with a default value of "metropolis"
         py::arg("verbose") = 1, // Define the verbosity with a default value of 1
+        py::arg("cache_mb") = 0, // Define the value cache size with a default value of 0 (disabled)
+        py::arg("full_output") = false, // Define the full output flag with a default value of false
+        py::arg("replicas") = 1, // Define the number of replicas with a default value of 1 (no replica exchange)
+        py::arg("ladder") = std::vector<double>(), // Define the replica temperatures with a default geometric ladder
+        py::arg("swap_interval") = 10, // Define the number of iterations between exchanges with a default value of 10
+        py::arg("neighbor_params") = py::dict(), // Define the neighbor generator parameters with a default value of {}
+        py::arg("temperature_params") = py::dict(), // Define the temperature schedule parameters with a default value of {}
+        py::arg("callback") = py::none(), // Define the per-iteration callback with a default value of None
+        py::arg("callback_every") = 1, // Define the number of iterations between callbacks with a default value of 1
+        py::arg("checkpoint") = "", // Define the checkpoint file with a default value of "" (not saved)
+        py::arg("checkpoint_every") = 10, // Define the number of iterations between saves with a default value of 10
+        py::arg("resume") = false, // Define the resume flag with a default value of false
+        py::arg("max_evaluations") = 0, // Define the evaluation budget with a default value of 0 (no limit)
+        py::arg("max_time") = 0, // Define the time budget in seconds with a default value of 0 (no limit)
+        py::arg("target") = py::none(), // Define the target value with a default value of None
+        py::arg("patience") = 0, // Define the number of iterations without improvement with a default value of 0 (never stops)
+        py::arg("tolerance") = 0, // Define the smallest improvement with a default value of 0
+        py::arg("batch") = false, // Define the batch evaluation mode with a default value of false
         "Uses simulated annealing to minimize a function of double inputs" // Define the docstring
     );
 
@@ -112,11 +430,29 @@ PYBIND11_MODULE(annealing, m) { // Define the Python module
     m.def("anneal_int", &anneal<int>,
         py::arg("funct"), // Define the function to be minimized
         py::arg("initial"), // Define the initial parameters
-        py::arg("neighbor"), // Define the neighbor generation function
+        py::arg("neighbor"), // Define the neighbor generation function or built-in generator
         py::arg("iterations") = 100, // Define the number of iterations
-        py::arg("temperature") = py::cpp_function([](int iter) { return pow(0.999, iter); }), // Define the temperature schedule function with a default value
-        py::arg("acceptance"), // Define the acceptance probability function
+        py::arg("temperature") = "geometric", // Define the temperature schedule with a default value of "geometric"
+        py::arg("acceptance") = "metropolis", // Define the acceptance probability with a default value of "metropolis"
         py::arg("verbose") = 1, // Define the verbosity with a default value of 1
+        py::arg("cache_mb") = 0, // Define the value cache size with a default value of 0 (disabled)
+        py::arg("full_output") = false, // Define the full output flag with a default value of false
+        py::arg("replicas") = 1, // Define the number of replicas with a default value of 1 (no replica exchange)
+        py::arg("ladder") = std::vector<double>(), // Define the replica temperatures with a default geometric ladder
+        py::arg("swap_interval") = 10, // Define the number of iterations between exchanges with a default value of 10
+        py::arg("neighbor_params") = py::dict(), // Define the neighbor generator parameters with a default value of {}
+        py::arg("temperature_params") = py::dict(), // Define the temperature schedule parameters with a default value of {}
+        py::arg("callback") = py::none(), // Define the per-iteration callback with a default value of None
+        py::arg("callback_every") = 1, // Define the number of iterations between callbacks with a default value of 1
+        py::arg("checkpoint") = "", // Define the checkpoint file with a default value of "" (not saved)
+        py::arg("checkpoint_every") = 10, // Define the number of iterations between saves with a default value of 10
+        py::arg("resume") = false, // Define the resume flag with a default value of false
+        py::arg("max_evaluations") = 0, // Define the evaluation budget with a default value of 0 (no limit)
+        py::arg("max_time") = 0, // Define the time budget in seconds with a default value of 0 (no limit)
+        py::arg("target") = py::none(), // Define the target value with a default value of None
+        py::arg("patience") = 0, // Define the number of iterations without improvement with a default value of 0 (never stops)
+        py::arg("tolerance") = 0, // Define the smallest improvement with a default value of 0
+        py::arg("batch") = false, // Define the batch evaluation mode with a default value of false
         "Uses simulated annealing to minimize a function of integer inputs" // Define the docstring
     );
 
@@ -124,12 +460,34 @@ PYBIND11_MODULE(annealing, m) { // Define the Python module
     m.def("anneal_string", &anneal<std::string>,
         py::arg("funct"), // Define the function to be minimized
         py::arg("initial"), // Define the initial parameters
-        py::arg("neighbor"), // Define the neighbor generation function
+        py::arg("neighbor"), // Define the neighbor generation function or built-in generator
         py::arg("iterations") = 100, // Define the number of iterations
-        py::arg("temperature") = py::cpp_function([](int iter) { return pow(0.999, iter); }), // Define the temperature schedule function with a default value
-        py::arg("acceptance"), // Define the acceptance probability function
+        py::arg("temperature") = "geometric", // Define the temperature schedule with a default value of "geometric"
+        py::arg("acceptance") = "metropolis", // Define the acceptance probability with a default value of "metropolis"
         py::arg("verbose") = 1, // Define the verbosity with a default value of 1
+        py::arg("cache_mb") = 0, // Define the value cache size with a default value of 0 (disabled)
+        py::arg("full_output") = false, // Define the full output flag with a default value of false
+        py::arg("replicas") = 1, // Define the number of replicas with a default value of 1 (no replica exchange)
+        py::arg("ladder") = std::vector<double>(), // Define the replica temperatures with a default geometric ladder
+        py::arg("swap_interval") = 10, // Define the number of iterations between exchanges with a default value of 10
+        py::arg("neighbor_params") = py::dict(), // Define the neighbor generator parameters with a default value of {}
+        py::arg("temperature_params") = py::dict(), // Define the temperature schedule parameters with a default value of {}
+        py::arg("callback") = py::none(), // Define the per-iteration callback with a default value of None
+        py::arg("callback_every") = 1, // Define the number of iterations between callbacks with a default value of 1
+        py::arg("checkpoint") = "", // Define the checkpoint file with a default value of "" (not saved)
+        py::arg("checkpoint_every") = 10, // Define the number of iterations between saves with a default value of 10
+        py::arg("resume") = false, // Define the resume flag with a default value of false
+        py::arg("max_evaluations") = 0, // Define the evaluation budget with a default value of 0 (no limit)
+        py::arg("max_time") = 0, // Define the time budget in seconds with a default value of 0 (no limit)
+        py::arg("target") = py::none(), // Define the target value with a default value of None
+        py::arg("patience") = 0, // Define the number of iterations without improvement with a default value of 0 (never stops)
+        py::arg("tolerance") = 0, // Define the smallest improvement with a default value of 0
+        py::arg("batch") = false, // Define the batch evaluation mode with a default value of false
         "Uses simulated annealing to minimize a function of string inputs" // Define the docstring
     );
 
+    // Define ask/tell optimizer states for each parameter type
+    define_anneal_state<double>(m, "AnnealState", "Ask/tell simulated annealing state to minimize a function of double inputs");
+    define_anneal_state<int>(m, "AnnealStateInt", "Ask/tell simulated annealing state to minimize a function of integer inputs");
+    define_anneal_state<std::string>(m, "AnnealStateString", "Ask/tell simulated annealing state to minimize a function of string inputs");
 }
@@ -1,22 +1,35 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/numpy.h>
+#include "checkpoint.h"
+#include "monitor.h"
+#include "numpy_view.h"
+#include "objective.h"
+#include "termination.h"
+#include "quickopt/bohb.hpp"
+#include "quickopt/tpe.hpp"
 #include <iostream>
 #include <cmath>
 #include <algorithm>
 #include <random>
 #include <stdexcept>
+#include <string>
 #include <unordered_map>
 #include <vector>
 #include <limits>
+#include <memory>
 #include <type_traits>
+#include <cstdint>
 
 namespace py = pybind11;
+using quickopt::Phase;
+using quickopt::PhaseTimer;
 
 // Bayesian Optimization algorithm using Tree-structured Parzen Estimator (TPE)
-std::vector<double> bayesopt_tpe(
-    py::function funct, // The function to be *minimized*
-    std::vector<double> space_min, // Lower bound vector for the search space
-    std::vector<double> space_max, // Upper bound vector for the search space
+py::object bayesopt_tpe(
+    py::object funct, // The function to be *minimized* - a Python function, or a native objective (see objective.h)
+    numpy_vector<double> lower, // Lower bound vector for the search space
+    numpy_vector<double> upper, // Upper bound vector for the search space
     int iterations = 100, // Number of iterations to run the algorithm for
     int samples = 10, // Number of samples to draw initially
     int acquisition_samples = 100, // Number of samples to draw for acquisition function maximization
@@ -26,282 +39,151 @@ std::vector<double> bayesopt_tpe(
     std::vector<double> bandwidth = std::vector<double>(), // Optional bandwidth vector for the KDE (overrides dynamic bandwidth calculation)
     int prior_weight = 1, // Prior weight parameter for Non-Informative Prior
     double split = -107.2931, // Optional splitting threshold (overrides dynamic threshold calculation)
-    const std::vector<std::pair<std::vector<double>, double>>& seed = std::vector<std::pair<std::vector<double>, double>>() // Seed data for the algorithm
+    const std::vector<std::pair<std::vector<double>, double>>& seed = std::vector<std::pair<std::vector<double>, double>>(), // Seed data for the algorithm
+    std::string kde = "exact", // Kernel density estimation method - "exact" sums every candidate, "tree" approximates large sets with KD-trees
+    double kde_tolerance = 1e-3, // Maximum relative error of each density when kde is "tree"
+    int n_threads = 1, // Number of threads used to generate and score acquisition samples, and to evaluate batches with a native objective - 0 uses every hardware thread
+    long long rng_seed = -1, // Seed for the random number generator - negative for a nondeterministic seed
+    int batch_size = 1, // Number of points proposed and evaluated together each iteration - above 1, funct takes a (batch_size, dim) array and returns an array of values, unless it is native
+    bool full_output = false, // Whether to also return a dict of run information
+    py::object callback = py::none(), // Function receiving lists of per-evaluation records in place of the per-evaluation output
+    int callback_every = 1, // Number of iterations between calls to the callback
+    std::string checkpoint = "", // File the state of the run is saved to - empty for none
+    int checkpoint_every = 10, // Number of iterations between saves
+    bool resume = false, // Whether to continue the run saved in checkpoint, if the file exists
+    std::string trial_log = "", // File every evaluation is appended to, and whose trials are loaded as history - empty for none
+    std::string sampling = "uniform", // How acquisition samples are drawn - "uniform" over the search space, or "mixture" from the good set's density and the prior
+    long long max_evaluations = 0, // Number of evaluations after which the run stops - 0 for no limit
+    double max_time = 0, // Number of seconds after which the run stops - 0 for no limit
+    py::object target = py::none(), // Best value at which the run stops - None for none
+    int patience = 0, // Number of iterations without improvement after which the run stops - 0 to never stop
+    double tolerance = 0 // Smallest improvement of the best value that resets the patience
 ) {
 
-    // Check for invalid inputs
-    if (threshold > std::sqrt(samples)) { // If the threshold is greater than the square root of the number of samples...
-        throw std::invalid_argument("Threshold value must be at most √(samples)!"); // Throw an exception
-    }
-    if (threshold <= 0) { // If the threshold is less than or equal to 0...
-        throw std::invalid_argument("Threshold value must be positive!"); // Throw an exception
-    }
-    if (split != -107.2931 && (split < 0 || split > 1)) { // If the split value is not the default value and is not within the range [0, 1]...
-        throw std::invalid_argument("Split value must be within 0 and 1!"); // Throw an exception
-    }
-    if (group_cap < 2) { // If the group cap is less than 2...
-        throw std::invalid_argument("Group cap must be over 2!"); // Throw an exception
-    }
-    if (space_min.size() != space_max.size()) { // If the size of the lower bound vector is not equal to the size of the upper bound vector...
-        throw std::invalid_argument("Lower and upper bound vectors must be of the same size!"); // Throw an exception
-    }
-    if (bandwidth.size() != 0 && bandwidth.size() != space_min.size()) { // If the bandwidth vector is not empty and is not the same size as the search space...
-        throw std::invalid_argument("Bandwidth vector must be empty or of the same size as the search space!"); // Throw an exception
-    }
-    for (int i = 0; i < space_min.size(); i++) { // For each dimension in the search space...
-        if (space_min[i] >= space_max[i]) { // If the lower bound is greater than or equal to the upper bound...
-            throw std::invalid_argument("Lower bound must be less than upper bound for all dimensions!"); // Throw an exception
-        }
-    }
-    if (iterations <= 0) { // If the number of iterations is less than or equal to 0...
-        throw std::invalid_argument("Number of iterations must be positive!"); // Throw an exception
-    }
-    if (samples <= 0) { // If the number of samples is less than or equal to 0...
-        throw std::invalid_argument("Number of samples must be positive!"); // Throw an exception
-    }
-    if (acquisition_samples <= 0) { // If the number of acquisition samples is less than or equal to 0...
-        throw std::invalid_argument("Number of acquisition samples must be positive!"); // Throw an exception
-    }
-    
-
-    bool dynam = false; // Set the dynamic bandwidth flag to false
-    if (bandwidth.size() != space_min.size()){ // If the bandwidth vector is empty...
-        dynam = true; // Set the dynamic bandwidth flag to true
-        for (int i = 0; i < space_min.size(); i++) { // For each dimension in the search space...
-            bandwidth.push_back(((space_max[i] - space_min[i]) / 5.0) * (pow(samples, (-1.0 / (space_min.size() + 4))))); // Calculate the initial bandwidth and add it to the bandwidth vector
-            // This calculation is based on the heuristic in appendix C.3.3 of Watanbe 2023
-        }
-    }
-
-    std::mt19937 rng(std::random_device{}()); // Initialize the random number generator
-
-    class Candidate { // Define a Candidate class
-    public: // Public access specifier
-        std::vector<double> parameters; // Vector of parameters
-        double value; // Value of the candidate
-        double weights; // Weights of the candidate
-
-        Candidate(const std::vector<double>& p, double val, double w) // Constructor for the Candidate class
-            : parameters(p), value(val), weights(w) {} // Initialize the parameters, value, and weights
-    };
-
-    auto splitting = [threshold, split](double group_size) -> double { // Define a lambda function for splitting
-        if (split < 0 || split > 1) { // If the split value is not within the range [0, 1] (eg. it isn't provided)... 
-            return (threshold / std::sqrt(static_cast<double>(group_size))); // Return the threshold divided by the square root of the group size
-            // This calculation is based on the square root splitting algorithm used in Bergstra et al. 2013
-        }
-        return split;
-    };
-
-
-    std::vector<Candidate> dataset; // Vector of candidates
-    dataset.reserve(samples); // Reserve space for the candidates
-
-    std::vector<std::uniform_real_distribution<double>> distributions; // Vector of uniform real distributions
-    for (size_t j = 0; j < space_min.size(); j++) { // For each dimension in the search space...
-        distributions.emplace_back(space_min[j], space_max[j]); // Add a uniform real distribution with the corresponding lower and upper bounds
-    }
-
-    double bestValue = std::numeric_limits<double>::max(); // Initialize the best value to the maximum double value
-    std::vector<double> bestParameters(space_min.size(), 0); // Initialize the best parameters to zeros
-
-    for (int i = 0; i < samples; i++) { // For each sample...
-        if (i < seed.size()) { // If the sample is within the seed data...
-            dataset.emplace_back(seed[i].first, seed[i].second, 0); // Add the seed data to the dataset
+    NativeObjective native; // Native objective, if funct is one
+    bool is_native = native_objective(funct, native); // Whether funct is a native objective
+    quickopt::Monitor monitor; // Stats and records of the run
+    quickopt::Monitor* observer = python_monitor(monitor, full_output, callback, callback_every); // Monitor passed to the engine, or null
+    quickopt::Stats* stats = quickopt::stats_of(observer); // Per-phase timers, or null
+    quickopt::Checkpoint saves; // Where and how often the run is saved
+    const quickopt::Checkpoint* saved = python_checkpoint(saves, checkpoint, checkpoint_every, resume); // Checkpoint passed to the engine, or null
+    quickopt::Termination stopping; // Budgets and convergence tests of the run
+    quickopt::Termination* stop = python_termination(stopping, max_evaluations, max_time, target, patience, tolerance); // Termination tests passed to the engine, or null
+    std::unique_ptr<quickopt::TrialLog> log(trial_log.empty() ? nullptr : new quickopt::TrialLog(trial_log, lower.size())); // Log of every evaluation, or null
+
+    // Evaluate n points of dim parameters - natively, with a Python call per point, or with a single Python call per batch
+    auto evaluate = [&](const double* points, size_t n, size_t dim, double* values) {
+        if (is_native) { // If the objective is native...
+            for (size_t p = 0; p < n; ++p) { // For each point...
+                values[p] = native(points + p * dim, dim); // Evaluate it
+            }
+        } else if (batch_size == 1) { // If funct takes a single point...
+            for (size_t p = 0; p < n; ++p) { // For each point...
+                py::object view; // View of the point
+                {
+                    PhaseTimer timer(stats, Phase::marshalling);
+                    view = readonly_view(points + p * dim, dim);
+                }
+                py::object returned = funct(view); // Evaluate the function, passing a view of the point
+                PhaseTimer timer(stats, Phase::marshalling);
+                values[p] = returned.cast<double>();
+            }
         } else { // If not...
-            std::vector<double> parameters(space_min.size()); // Create a vector parameters of the same size as the search space
-            for (size_t j = 0; j < space_min.size(); j++) { // For each dimension in the search space...
-                parameters[j] = distributions[j](rng); // Generate a random parameter value using the corresponding distribution
+            py::object view; // View of the batch
+            {
+                PhaseTimer timer(stats, Phase::marshalling);
+                view = owning_view(std::vector<double>(points, points + n * dim), n, dim); // Copy the batch into an array that owns it, so the function may keep it
             }
-            double eval = funct(parameters).cast<double>(); // Evaluate the function at the generated parameters
-            if (eval < bestValue) { // If the evaluation is better than the best value...
-                bestValue = eval; // Update the best value
-                bestParameters = parameters; // Update the best parameters
+            py::object returned = funct(view); // Evaluate the whole (n, dim) batch in a single call
+            PhaseTimer timer(stats, Phase::marshalling);
+            auto result = returned.cast<numpy_vector<double>>();
+            if (result.size() != static_cast<py::ssize_t>(n)) { // If the function did not return one value per point...
+                throw std::invalid_argument("Batch function must return one value per point!"); // Throw an exception
             }
-            dataset.emplace_back(parameters, eval, 0); // Add the generated parameters, evaluation, and weights to the dataset as a candidate
-        }
-    }
-
-    std::vector<Candidate> good; // Vector to hold set of good candidates
-    std::vector<Candidate> bad; // Vector to hold set of bad candidates
-
-    int toReserve = std::min(std::max(2, static_cast<int>(std::floor(static_cast<double>(samples) * (splitting(samples))))), group_cap); // Calculate the number of samples to reserve
-    // Note we cap the number of samples to reserve at group_cap, and we ensure that at least 2 samples are reserved
-
-    good.reserve(toReserve); // Reserve space for the good candidates
-    bad.reserve(samples - toReserve); // Reserve space for the bad candidates
-
-    std::unordered_map<int, double> denom_dict; // Memoization dictionary to hold denominator values in weight calculations
-
-    auto denom_weight = [&denom_dict](std::vector<Candidate>& good) -> double { // Define a helper lambda function to calculate the denominator in the weight calculation
-
-        int good_size = good.size(); // Get the size of the good candidates
-        double yq = good.back().value; // Get the value of the last good candidate
-
-        if (denom_dict.find(good_size) != denom_dict.end()) { // If the denominator value is already in the memoization dictionary...
-            return denom_dict[good_size]; // Return the value from the dictionary
-        }
-
-        // If not...
-        double denominator = 0; // Initialize the denominator to zero
-
-        for (Candidate &c : good) { // For each good candidate...
-            denominator += (1.0 / (1.0 + good_size)) * (yq - c.value); // Add on their denominator value
-        }
-
-        denom_dict[good_size] = denominator; // Add the denominator value to the memoization dictionary
-        return denominator; // Return the denominator value
-    };
-
-
-    auto weight = [&denom_weight](bool isGood, std::vector<Candidate>& good, std::vector<Candidate>& bad, Candidate& c) -> double { // Define a lambda function to calculate the weight of a candidate
-    // This weight is based on the expected improvement acquisition function shown in Song et al. 2022
-
-        if (!isGood) { // If the candidate is in the bad set...
-            return 1.0 / (bad.size() + 1); // Return the weight scaled by the size of the bad set
-        }
-
-        // If not...
-        double denominator = denom_weight(good);  // Calculate the denominator value using our helper function
-        return (good.back().value - c.value) / denominator; // Return the weight based on the expected improvement acquisition function
-    };
-
-    auto weight_base = [&denom_weight](std::vector<Candidate>& good) -> double { // Define a lambda function to calculate the weight for the zeroth basis in the KDE
-    // This weight is based on the expected improvement acquisition function shown in Song et al. 2022
-
-        double baseweight = 0; // Initialize the base weight to zero
-
-        for (const Candidate& candidate : good) { // For each good candidate...
-            baseweight += denom_weight(good) * candidate.weights; // Add on the weight of the candidate
-        }
-
-        return baseweight / good.size(); // Return the average weight of all good candidates
-    };
-
-    auto nonInformativePrior = [&space_min, &space_max](double param, int ind) -> double { // Define a lambda function to calculate the non-informative prior for an individual dimension
-    // This prior is based on a Gaussian distribution with a mean at the midpoint of the search space and a standard deviation of the search space width
-    // This is based on Watanabe 2023
-        double left = space_min[ind]; // Get the lower bound of the search space
-        double right = space_max[ind]; // Get the upper bound of the search space
-        double mean = (left + right) / 2.0; // Calculate the mean of the search space
-        double sigma = (right - left); // Calculate the standard deviation of the search space
-        double exponent = -std::pow(param - mean, 2) / (2 * std::pow(sigma, 2)); // Calculate the exponent of the Gaussian distribution
-        double pdf = (1.0 / (sigma * std::sqrt(2 * M_PI))) * std::exp(exponent); // Calculate the probability density function of the Gaussian distribution
-        return pdf;
-    };
-
-    auto nIp = [&nonInformativePrior, prior_weight](const std::vector<double>& params) -> double { // Define a lambda function to calculate the non-informative prior for a set of parameters
-        double runningProd = 1; // Initialize the running product to one
-        for (size_t i = 0; i < params.size(); i++) { // For each dimension...
-            runningProd *= nonInformativePrior(params[i], i); // Multiply the running product by the non-informative prior for that dimension
+            std::copy(result.data(), result.data() + n, values); // Store the values of the batch
         }
-        return runningProd * prior_weight; // Return the running product scaled by the prior weight
     };
 
-    auto gaussianKernel = [](double x, double xn, double bw) -> double { // Define a lambda function to calculate the Gaussian kernel given a bandwidth hyperparameter
-    // This kernel is described in Watanbe 2023
-
-        return (1.0 / std::sqrt(2 * M_PI * bw * bw)) * // Calculate the Gaussian kernel
-               std::exp(-std::pow(x - xn, 2) / (2 * bw * bw)); // Calculate the exponent of the Gaussian kernel
-    };
+    std::vector<double> best = quickopt::bayesopt_tpe<py::gil_scoped_release>(evaluate, to_vector(lower), to_vector(upper), iterations, samples, acquisition_samples, verbose,
+                                                                              threshold, group_cap, bandwidth, prior_weight, split, seed, kde, kde_tolerance, n_threads, rng_seed,
+                                                                              batch_size, is_native, observer, saved, log.get(), sampling, stop); // Best parameters found
+    if (!full_output) { // If only the parameters were asked for...
+        return result_params(best); // Return the best parameters
+    }
+    py::dict info; // Run information
+    info["stats"] = stats_dict(monitor.stats); // Time spent in each phase, and the number of evaluations
+    info["stop_reason"] = quickopt::stop_reason_name(stopping.reason()); // Criterion that ended the run
+    return py::make_tuple(result_params(best), info); // Return the best parameters and the run information
+}
 
-    auto kde = [&gaussianKernel, &bandwidth](const std::vector<double>& params, const std::vector<Candidate>& candidates) -> double { // Define a lambda function to calculate the kernel density estimate
-    // This is based on the multivariate kernel density estimation used in Falkner et al. 2018
+// Multi-fidelity Bayesian optimization (BOHB) - Hyperband's successive-halving brackets, with new configurations proposed by TPE
+py::object bohb(
+    py::object funct, // The function to be *minimized* - a Python function taking the parameters and the budget to evaluate them with
+    numpy_vector<double> lower, // Lower bound vector for the search space
+    numpy_vector<double> upper, // Upper bound vector for the search space
+    double min_budget = 1, // Smallest budget a configuration is evaluated with
+    double max_budget = 27, // Largest budget a configuration is evaluated with
+    double eta = 3, // Factor the budget grows by, and the number of configurations shrinks by, at each rung of a bracket
+    int iterations = 10, // Number of brackets to run
+    double random_fraction = 1.0 / 3.0, // Fraction of configurations drawn uniformly instead of proposed by the model
+    int min_points = 0, // Number of evaluations a budget needs before its model proposes configurations - 0 for the number of parameters plus 2
+    int acquisition_samples = 100, // Number of samples to draw for acquisition function maximization
+    int verbose = 1, // Verbosity level - 0 for final output, 1 for output at each evaluation
+    double threshold = 0.5, // Threshold value for the splitting function - unnecessary if split is provided
+    int group_cap = 9999, // Group cap for the good set
+    std::vector<double> bandwidth = std::vector<double>(), // Optional bandwidth vector for the KDE (overrides dynamic bandwidth calculation)
+    int prior_weight = 1, // Prior weight parameter for Non-Informative Prior
+    double split = -107.2931, // Optional splitting threshold (overrides dynamic threshold calculation)
+    std::string kde = "exact", // Kernel density estimation method - "exact" sums every candidate, "tree" approximates large sets with KD-trees
+    double kde_tolerance = 1e-3, // Maximum relative error of each density when kde is "tree"
+    int n_threads = 1, // Number of threads used to generate and score acquisition samples - 0 uses every hardware thread
+    long long rng_seed = -1, // Seed for the random number generator - negative for a nondeterministic seed
+    bool full_output = false, // Whether to also return a dict of run information
+    py::object callback = py::none(), // Function receiving lists of per-evaluation records in place of the per-evaluation output
+    int callback_every = 1, // Number of evaluations between calls to the callback
+    std::string sampling = "uniform", // How acquisition samples are drawn - "uniform" over the search space, or "mixture" from the good set's density and the prior
+    long long max_evaluations = 0, // Number of evaluations after which the run stops - 0 for no limit
+    double max_time = 0, // Number of seconds after which the run stops - 0 for no limit
+    py::object target = py::none(), // Best value at which the run stops - None for none
+    int patience = 0, // Number of brackets without improvement after which the run stops - 0 to never stop
+    double tolerance = 0 // Smallest improvement of the best value that resets the patience
+) {
 
-        double runningSum = 0; // Initialize the running sum to zero
-        for (const Candidate& c : candidates) { // For each candidate...
-            double runningProd = 1; // Initialize the running product to one
-            for (size_t i = 0; i < params.size(); i++) { // For each dimension...
-                runningProd *= gaussianKernel(params[i], c.parameters[i], bandwidth[i]); // Multiply the running product by the Gaussian kernel
-            } 
-            runningSum += runningProd * c.weights; // Multiply the running product by the weight of the candidate and add it to the running sum
+    NativeObjective native; // Native objectives take no budget, so are rejected
+    if (native_objective(funct, native)) { // If funct is a native objective...
+        throw std::invalid_argument("BOHB requires a Python function taking a budget!"); // Throw an exception
+    }
+    quickopt::Monitor monitor; // Stats and records of the run
+    quickopt::Monitor* observer = python_monitor(monitor, full_output, callback, callback_every); // Monitor passed to the engine, or null
+    quickopt::Stats* stats = quickopt::stats_of(observer); // Per-phase timers, or null
+    quickopt::Termination stopping; // Budgets and convergence tests of the run
+    quickopt::Termination* stop = python_termination(stopping, max_evaluations, max_time, target, patience, tolerance); // Termination tests passed to the engine, or null
+    double spent = 0; // Sum of the budgets of every evaluation
+
+    // Evaluate a configuration with a budget, with a single Python call
+    auto evaluate = [&](const double* params, size_t dim, double budget) -> double {
+        spent += budget;
+        py::object view; // View of the configuration
+        {
+            PhaseTimer timer(stats, Phase::marshalling);
+            view = readonly_view(params, dim);
         }
-        return runningSum / candidates.size(); // Return running sum scaled by the number of candidates
+        py::object returned = funct(view, budget); // Evaluate the function, passing a view of the configuration and its budget
+        PhaseTimer timer(stats, Phase::marshalling);
+        return returned.cast<double>();
     };
 
-    for (int i = 1; i < iterations; i++) { // For each iteration...
-
-        toReserve = std::min(std::max(2, static_cast<int>(std::floor(dataset.size() * (splitting(dataset.size()))))), group_cap); // Recalculate the number of candidates to reserve
-
-        std::sort(dataset.begin(), dataset.end(), [](const Candidate& a, const Candidate& b) { // Sort the dataset by value
-            return a.value < b.value; // Lower values first
-        });
-
-        good.clear(); // Clear the good set
-        bad.clear(); // Clear the bad set
-
-        for (size_t j = 0; j < dataset.size(); j++) { // For each candidate in the dataset...
-            if (j < static_cast<size_t>(toReserve)) { // If there is still space in the good set...
-                good.push_back(dataset[j]); // Add the candidate to the good set
-            } else { // If not...
-                bad.push_back(dataset[j]); // Add the candidate to the bad set
-            }
-        }
-
-
-        for (Candidate &c : good) { // For each candidate in the good set...
-            c.weights = weight(true, good, bad, c); // Calculate the weight of the candidate
-        }
-
-        for (Candidate &c : bad) { // For each candidate in the bad set...
-            c.weights = weight(false, good, bad, c); // Calculate the weight of the candidate
-        }
-
-
-        double w0 = weight_base(good); // Calculate the weight of the zeroth basis in the KDE
-
-        auto acquisition = [&good, &bad, &kde, &nIp, w0](const std::vector<double>& params) -> double { // Define a lambda function to calculate the acquisition function's value for given parameters
-            double badAcq = kde(params, bad); // Calculate the kernel density estimate for the bad candidates
-            double goodAcq = kde(params, good); // Calculate the kernel density estimate for the good candidates
-            double p0 = nIp(params); // Calculate the non-informative prior for the parameters
-            return (goodAcq + w0 * p0) / (badAcq + w0 * p0); // Return the acquisition function's values
-        };
-
-        std::vector<std::vector<double>> acsamples; // Initialize the acquisition samples vector
-        acsamples.reserve(acquisition_samples); // Reserve space for the acquisition samples
-
-        for (int j = 0; j < acquisition_samples; j++) { // For each acquisition sample...
-            std::vector<double> sample(space_min.size()); // Initialize the sample vector
-            for (size_t k = 0; k < space_min.size(); k++) { // For each dimension...
-                sample[k] = distributions[k](rng); // Generate a random value within the search space
-            }
-            acsamples.push_back(std::move(sample)); // Add the random sample to the acquisition samples
-        }
-
-        double bestAcq = -1 * std::numeric_limits<double>::max(); // Initialize the best acquisition value to negative infinity
-        std::vector<double> bestSample; // Initialize the best sample vector
-
-        for (const std::vector<double>& sample : acsamples) { // For each acquisition sample...
-            double acq = acquisition(sample); // Calculate the acquisition function's value for the sample
-            if (acq > bestAcq) { // If the acquisition value is better than the best acquisition value...
-                bestAcq = acq; // Update the best acquisition value
-                bestSample = sample; // Update the best sample (parameters)
-            }
-        }
-
-        std::vector<double> newParameters(bestSample.begin(), bestSample.end()); // Initialize the new parameters vector using the best sample
-
-        double eval = funct(newParameters).cast<double>(); // Evaluate the function at the new parameters
-        if (eval < bestValue) { // If the evaluation is better than the best value...
-            bestValue = eval; // Update the best value
-            bestParameters = newParameters; // Update the best parameters
-        }
-        dataset.emplace_back(newParameters, eval, 0); // Add the new candidate to the dataset
-
-        if (verbose == 1) { // If verbose output is enabled...
-            std::cout << "Iteration " << i << ": " << eval << std::endl; // Print the iteration number and evaluation
-            std::cout << "Best value: " << bestValue << std::endl; // Print the best value
-        }
-
-        if (dynam) { // If dynamic bandwidth is enabled...
-            for (size_t i = 0; i < space_min.size(); i++) {  // For each dimension...
-                bandwidth[i] = ((space_max[i] - space_min[i]) / 5.0) * (pow(dataset.size(), (-1.0 / (space_min.size() + 4)))); // Update the bandwidth
-                // // This calculation is based on the heuristic in appendix C.3.3 of Watanabe 2023
-            }
-        }
+    std::vector<double> best = quickopt::bohb<py::gil_scoped_release>(evaluate, to_vector(lower), to_vector(upper), min_budget, max_budget, eta, iterations, random_fraction,
+                                                                      min_points, acquisition_samples, verbose, threshold, group_cap, bandwidth, prior_weight, split, kde,
+                                                                      kde_tolerance, n_threads, rng_seed, false, observer, sampling, stop); // Best parameters found
+    if (!full_output) { // If only the parameters were asked for...
+        return result_params(best); // Return the best parameters
     }
-
-    return bestParameters; // Return the best parameters
+    py::dict info; // Run information
+    info["stats"] = stats_dict(monitor.stats); // Time spent in each phase, and the number of evaluations
+    info["stop_reason"] = quickopt::stop_reason_name(stopping.reason()); // Criterion that ended the run
+    info["total_budget"] = spent; // Sum of the budgets of every evaluation
+    return py::make_tuple(result_params(best), info); // Return the best parameters and the run information
 }
 
 PYBIND11_MODULE(bayesopt_tpe, m) { // Define the Python module
@@ -319,6 +201,57 @@ PYBIND11_MODULE(bayesopt_tpe, m) { // Define the Python module
         py::arg("prior_weight") = 1, // Define the prior_weight argument with a default value
         py::arg("split") = -107.2931, // Define the split argument with a default value
         py::arg("seed") = std::vector<std::pair<std::vector<double>, double>>(), // Define the seed argument with a default value
+        py::arg("kde") = "exact", // Define the kde argument with a default value
+        py::arg("kde_tolerance") = 1e-3, // Define the kde_tolerance argument with a default value
+        py::arg("n_threads") = 1, // Define the n_threads argument with a default value
+        py::arg("rng_seed") = -1, // Define the rng_seed argument with a default value
+        py::arg("batch_size") = 1, // Define the batch_size argument with a default value
+        py::arg("full_output") = false, // Define the full_output argument with a default value
+        py::arg("callback") = py::none(), // Define the callback argument with a default value
+        py::arg("callback_every") = 1, // Define the callback_every argument with a default value
+        py::arg("checkpoint") = "", // Define the checkpoint argument with a default value
+        py::arg("checkpoint_every") = 10, // Define the checkpoint_every argument with a default value
+        py::arg("resume") = false, // Define the resume argument with a default value
+        py::arg("trial_log") = "", // Define the trial_log argument with a default value
+        py::arg("sampling") = "uniform", // Define the sampling argument with a default value
+        py::arg("max_evaluations") = 0, // Define the max_evaluations argument with a default value
+        py::arg("max_time") = 0, // Define the max_time argument with a default value
+        py::arg("target") = py::none(), // Define the target argument with a default value
+        py::arg("patience") = 0, // Define the patience argument with a default value
+        py::arg("tolerance") = 0, // Define the tolerance argument with a default value
         "Uses Bayesian Optimization with Tree-structured Parzen Estimator to find the minimum of a function" // Define the function's docstring
     );
+
+    m.def("bohb", &bohb, // Expose the bohb function to Python
+        py::arg("funct"), // Define the function argument
+        py::arg("space_min"), // Define the space_min argument
+        py::arg("space_max"), // Define the space_max argument
+        py::arg("min_budget") = 1, // Define the min_budget argument with a default value
+        py::arg("max_budget") = 27, // Define the max_budget argument with a default value
+        py::arg("eta") = 3, // Define the eta argument with a default value
+        py::arg("iterations") = 10, // Define the iterations argument with a default value
+        py::arg("random_fraction") = 1.0 / 3.0, // Define the random_fraction argument with a default value
+        py::arg("min_points") = 0, // Define the min_points argument with a default value
+        py::arg("acquisition_samples") = 100, // Define the acquisition_samples argument with a default value
+        py::arg("verbose") = 1, // Define the verbose argument with a default value
+        py::arg("threshold") = 0.5, // Define the threshold argument with a default value
+        py::arg("group_cap") = 9999, // Define the group_cap argument with a default value
+        py::arg("bandwidth") = std::vector<double>(), // Define the bandwidth argument with a default value
+        py::arg("prior_weight") = 1, // Define the prior_weight argument with a default value
+        py::arg("split") = -107.2931, // Define the split argument with a default value
+        py::arg("kde") = "exact", // Define the kde argument with a default value
+        py::arg("kde_tolerance") = 1e-3, // Define the kde_tolerance argument with a default value
+        py::arg("n_threads") = 1, // Define the n_threads argument with a default value
+        py::arg("rng_seed") = -1, // Define the rng_seed argument with a default value
+        py::arg("full_output") = false, // Define the full_output argument with a default value
+        py::arg("callback") = py::none(), // Define the callback argument with a default value
+        py::arg("callback_every") = 1, // Define the callback_every argument with a default value
+        py::arg("sampling") = "uniform", // Define the sampling argument with a default value
+        py::arg("max_evaluations") = 0, // Define the max_evaluations argument with a default value
+        py::arg("max_time") = 0, // Define the max_time argument with a default value
+        py::arg("target") = py::none(), // Define the target argument with a default value
+        py::arg("patience") = 0, // Define the patience argument with a default value
+        py::arg("tolerance") = 0, // Define the tolerance argument with a default value
+        "Uses BOHB - Hyperband with Tree-structured Parzen Estimator proposals - to find the minimum of a function evaluated with a budget" // Define the function's docstring
+    );
 }
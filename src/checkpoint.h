@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include "quickopt/checkpoint.hpp"
+
+// Checkpoint of a run called from Python - returns null if no path was given, so the run is not saved
+inline const quickopt::Checkpoint* python_checkpoint(quickopt::Checkpoint& checkpoint, const std::string& path, int checkpoint_every, bool resume) {
+    if (checkpoint_every < 1) { // If the checkpoint interval is not positive...
+        throw std::invalid_argument("Checkpoint interval must be at least 1!"); // Throw an exception
+    }
+    if (path.empty()) { // If the run is not saved...
+        if (resume) { // If it was asked to resume...
+            throw std::invalid_argument("Resuming requires a checkpoint path!"); // Throw an exception
+        }
+        return nullptr;
+    }
+    checkpoint.path = path;
+    checkpoint.interval = checkpoint_every;
+    checkpoint.resume = resume;
+    return &checkpoint;
+}
@@ -5,14 +5,142 @@
 #include <random>
 #include <stdexcept>
 #include <type_traits>
+#include <numeric>
+#include <limits>
+#include <memory>
+#include <atomic>
+#include <cmath>
+#include <string>
+#include "quickopt/eval_cache.hpp"
+#include "quickopt/genetic.hpp"
+#include "quickopt/thread_pool.hpp"
+#include "checkpoint.h"
+#include "monitor.h"
+#include "numpy_view.h"
+#include "objective.h"
+#include "operator_params.h"
+#include "process_pool.h"
+#include "termination.h"
 
 namespace py = pybind11;
 
+using quickopt::EvalCache;
+using quickopt::GeneticOperators;
+using quickopt::Phase;
+using quickopt::PhaseTimer;
+using quickopt::Population;
+using quickopt::ThreadPool;
+
+// Select the genetic operators from Python arguments - the crossover by name, and the mutation as a Python function or the name of a built-in one, each configured by its dict
+// Crossover: "single_point", "k_point" (k), "uniform" (p), and for doubles "blend" (alpha) and "sbx" (eta), both optionally clamped to [low, high]
+// Mutation: a Python function, or "gaussian" (sigma, low, high) for numbers, "polynomial" (eta, low, high) for doubles, "bit_flip" (bits) for integers,
+// "swap" for any type, and "char_substitution" (alphabet) for strings; each named mutation but "swap" changes every gene with probability gene_rate
+template <typename T>
+GeneticOperators<T> genetic_operators(py::object mutate, const std::string& crossover_name, const py::dict& crossover_params, const py::dict& mutation_params) {
+    using Operators = GeneticOperators<T>;
+    Operators operators; // Selected operators
+    // Select the crossover operator
+    OperatorParams cp("crossover", crossover_name, crossover_params);
+    if (crossover_name == "single_point") {
+        operators.crossover_op = Operators::Crossover::single_point;
+    } else if (crossover_name == "k_point") {
+        operators.crossover_op = Operators::Crossover::k_point;
+        operators.k = static_cast<int>(cp.number("k", 2)); // Number of cut points
+        if (operators.k < 1 || operators.k > 64) { // If there are too few or too many cut points...
+            throw std::invalid_argument("k must be within 1 and 64!"); // Throw an exception
+        }
+    } else if (crossover_name == "uniform") {
+        operators.crossover_op = Operators::Crossover::uniform;
+        operators.swap_p = cp.number("p", 0.5); // Probability of taking each gene from the mother
+    } else if (crossover_name == "blend" || crossover_name == "sbx") {
+        if (!std::is_same<T, double>::value) { // If the parameters are not doubles...
+            throw std::invalid_argument("Crossover \"" + crossover_name + "\" only supports double parameters!"); // Throw an exception
+        }
+        operators.crossover_op = crossover_name == "blend" ? Operators::Crossover::blend : Operators::Crossover::sbx;
+        if (operators.crossover_op == Operators::Crossover::blend) {
+            operators.alpha = cp.number("alpha", 0.5); // Extension of the parents' range on each side
+        } else {
+            operators.crossover_eta = cp.number("eta", 15.0); // Distribution index - larger keeps children closer to their parents
+        }
+        operators.crossover_bounded = cp.has("low") || cp.has("high");
+        operators.crossover_low = cp.number("low", std::numeric_limits<double>::lowest());
+        operators.crossover_high = cp.number("high", std::numeric_limits<double>::max());
+    } else {
+        throw std::invalid_argument("Unknown crossover \"" + crossover_name + "\"!"); // Throw an exception
+    }
+    cp.finish();
+
+    // Select the mutation operator
+    if (!py::isinstance<py::str>(mutate)) { // If the mutation is a Python function...
+        operators.mutation_op = Operators::Mutation::custom;
+        operators.custom_mutate = [mutate](const std::vector<T>& params) {
+            py::gil_scoped_acquire acquire; // Islands breed on threads without the GIL
+            return mutate(params).template cast<std::vector<T>>();
+        };
+        OperatorParams("mutation", "function", mutation_params).finish(); // It takes no parameters
+        return operators;
+    }
+    std::string mutation_name = mutate.cast<std::string>();
+    OperatorParams mp("mutation", mutation_name, mutation_params);
+    if (mutation_name == "gaussian") {
+        if (!std::is_arithmetic<T>::value) { // If the parameters are not numbers...
+            throw std::invalid_argument("Mutation \"gaussian\" only supports numeric parameters!"); // Throw an exception
+        }
+        operators.mutation_op = Operators::Mutation::gaussian;
+        operators.sigma = mp.number("sigma", std::is_integral<T>::value ? 1.0 : 0.1); // Standard deviation of each change
+    } else if (mutation_name == "polynomial") {
+        if (!std::is_same<T, double>::value) { // If the parameters are not doubles...
+            throw std::invalid_argument("Mutation \"polynomial\" only supports double parameters!"); // Throw an exception
+        }
+        if (!mp.has("low") || !mp.has("high")) { // If the bounds are missing...
+            throw std::invalid_argument("Mutation \"polynomial\" requires low and high!"); // Throw an exception
+        }
+        operators.mutation_op = Operators::Mutation::polynomial;
+        operators.mutation_eta = mp.number("eta", 20.0); // Distribution index - larger makes smaller changes
+    } else if (mutation_name == "bit_flip") {
+        if (!std::is_integral<T>::value) { // If the parameters are not integers...
+            throw std::invalid_argument("Mutation \"bit_flip\" only supports integer parameters!"); // Throw an exception
+        }
+        operators.mutation_op = Operators::Mutation::bit_flip;
+        operators.bits = static_cast<int>(mp.number("bits", 1)); // Number of low operators.bits that may be flipped - 1 for 0/1 genomes
+        if (operators.bits < 1 || operators.bits > 31) { // If the operators.bits do not fit an int...
+            throw std::invalid_argument("bits must be within 1 and 31!"); // Throw an exception
+        }
+    } else if (mutation_name == "swap") {
+        operators.mutation_op = Operators::Mutation::swap;
+    } else if (mutation_name == "char_substitution") {
+        if (!std::is_same<T, std::string>::value) { // If the parameters are not strings...
+            throw std::invalid_argument("Mutation \"char_substitution\" only supports string parameters!"); // Throw an exception
+        }
+        operators.mutation_op = Operators::Mutation::char_substitution;
+        operators.alphabet = mp.text("alphabet", printable_ascii()); // Characters substituted in
+        if (operators.alphabet.empty()) { // If there is nothing to substitute...
+            throw std::invalid_argument("Alphabet must not be empty!"); // Throw an exception
+        }
+    } else {
+        throw std::invalid_argument("Unknown mutation \"" + mutation_name + "\"!"); // Throw an exception
+    }
+    if (operators.mutation_op != Operators::Mutation::swap) { // If the mutation changes individual genes...
+        operators.gene_rate = mp.number("gene_rate", -1.0); // Probability of changing each gene - negative for 1 / dim
+    }
+    if (operators.mutation_op == Operators::Mutation::gaussian || operators.mutation_op == Operators::Mutation::polynomial) { // If the mutation can leave the search space...
+        operators.mutation_bounded = mp.has("low") || mp.has("high");
+        operators.mutation_low = mp.number("low", std::numeric_limits<double>::lowest());
+        operators.mutation_high = mp.number("high", std::numeric_limits<double>::max());
+    }
+    mp.finish();
+    return operators;
+}
+
+// Worker process pool for a parameter type - strings cannot live in shared memory, so they get a placeholder that is never created
+template <typename T>
+using GeneticWorkers = ProcessPool<typename std::conditional<std::is_arithmetic<T>::value, T, double>::type>;
+
 // Genetic algorithm function
 template <typename T>
-std::vector<T> genetic(
-    py::function fitness, // Fitness function - takes in a set of parameters and returns a fitness value
-    py::function mutate,  // Mutation function - takes in a set of parameters and returns a mutated set of parameters
+py::object genetic(
+    py::object fitness, // Fitness function - takes in a set of parameters and returns a fitness value; may be a native objective for doubles (see objective.h)
+    py::object mutate,  // Mutation function - takes in a set of parameters and returns a mutated set of parameters; or the name of a built-in mutation (see Operators)
     py::function generate, // Generate function - generates a set of parameters to be used in the initial population (ideally randomly)
     std::vector<std::vector<T>> seed = std::vector<std::vector<T>>(), // Seed population - a predefined set of parameters to be used in the initial population
     int population_size = 100, // Population size - more is better, but slower
@@ -20,97 +148,245 @@ std::vector<T> genetic(
     int survivor_ct = 0, // Number of individuals that will survive each generation - more leads to more stability, but could harm diversity
     double mutation_rate = 0.1, // Mutation rate - the probability that a mutation will occur on a given individual
     int generations = 100, // Number of generations to run the algorithm for
-    int verbose = 1 // Verbosity level - 0 for no output, 1 for average and top fitness each generation
+    int verbose = 1, // Verbosity level - 0 for no output, 1 for average and top fitness each generation
+    int n_threads = 1, // Number of threads evaluating a native fitness function - 0 uses every hardware thread
+    int n_workers = 0, // Number of worker processes evaluating a Python fitness function - 0 evaluates it in this process
+    std::string crossover = "single_point", // Name of the built-in crossover (see Operators)
+    py::dict crossover_params = py::dict(), // Parameters of the crossover
+    py::dict mutation_params = py::dict(), // Parameters of the built-in mutation
+    int islands = 1, // Number of islands evolving separate populations on their own threads - 1 evolves a single population
+    int migration_interval = 10, // Number of generations between migrations
+    int migrants = 1, // Number of individuals each island sends to each neighbour per migration
+    std::string topology = "ring", // Migration topology - "ring" sends to the next island, "full" to every other island
+    double cache_mb = 0, // Memory cap of the fitness cache in megabytes - 0 disables it
+    bool full_output = false, // Whether to also return a dict of run information
+    py::object callback = py::none(), // Function receiving lists of per-generation records in place of the per-generation output
+    int callback_every = 1, // Number of generations between calls to the callback
+    std::string checkpoint = "", // File the state of the run is saved to - empty for none
+    int checkpoint_every = 10, // Number of generations between saves
+    bool resume = false, // Whether to continue the run saved in checkpoint, if the file exists
+    long long max_evaluations = 0, // Number of evaluations after which the run stops - 0 for no limit
+    double max_time = 0, // Number of seconds after which the run stops - 0 for no limit
+    py::object target = py::none(), // Best value at which the run stops - None for none
+    int patience = 0, // Number of generations without improvement after which the run stops - 0 to never stop
+    double tolerance = 0, // Smallest improvement of the best value that resets the patience
+    double min_diversity = 0, // Spread of the population below which the run stops - 0 to never stop
+    long long rng_seed = -1 // Seed for the random number generators - negative for nondeterministic seeds
 ) {
-    
-    // Individual class to store parameters and fitness value
-    class Individual {
-    public:
-        std::vector<T> params; // Parameters for each individual
-        double fitness_value; // Fitness of each individual
 
-        Individual(const std::vector<T>& params, py::function& fitness)  // Constructor to calculate the fitness value automatically
-            : params(params), fitness_value(fitness(params).template cast<double>()) {
-        }
-    };
+    NativeObjective native; // Native fitness function, if fitness is one
+    bool is_native = native_objective(fitness, native); // Whether fitness is a native fitness function
 
-    if (reproduction_ct > population_size) { // Check if reproduction count is greater than population size...
-        throw std::invalid_argument("reproduction_ct cannot be greater than population_size"); // If so, throw an exception
+    // Check for invalid inputs
+    if (is_native && !std::is_same<T, double>::value) { // If a native fitness function was given for non-double parameters...
+        throw std::invalid_argument("Native fitness functions only support double parameters!"); // Throw an exception
+    }
+    if (n_threads < 0) { // If the number of threads is negative...
+        throw std::invalid_argument("Number of threads must be non-negative!"); // Throw an exception
+    }
+    if (n_workers < 0) { // If the number of worker processes is negative...
+        throw std::invalid_argument("Number of workers must be non-negative!"); // Throw an exception
+    }
+    if (n_workers > 0 && (is_native || !std::is_arithmetic<T>::value)) { // If worker processes were requested for a native fitness function or for strings...
+        throw std::invalid_argument("Worker processes require a Python fitness function of numeric parameters!"); // Throw an exception
+    }
+    if (islands < 1) { // If there are no islands...
+        throw std::invalid_argument("Number of islands must be positive!"); // Throw an exception
+    }
+    if (migration_interval < 1) { // If the migration interval is not positive...
+        throw std::invalid_argument("Migration interval must be positive!"); // Throw an exception
+    }
+    if (migrants < 0) { // If the number of migrants is negative...
+        throw std::invalid_argument("Number of migrants must be non-negative!"); // Throw an exception
+    }
+    if (topology != "ring" && topology != "full") { // If the topology is unknown...
+        throw std::invalid_argument("Topology must be \"ring\" or \"full\"!"); // Throw an exception
+    }
+    if (islands > 1 && n_workers > 0) { // If worker processes were requested in island mode...
+        throw std::invalid_argument("Worker processes are not supported with islands!"); // Throw an exception
+    }
+    if (cache_mb < 0) { // If the cache size is negative...
+        throw std::invalid_argument("Cache size must be non-negative!"); // Throw an exception
     }
 
-    std::vector<Individual> population; // Population vector - defined as a set of individuals
-    population.reserve(population_size); // Reserve space for the population based on population size
-    std::mt19937 rng(std::random_device{}()); // Random number generator
-    std::uniform_int_distribution<> dist(0, population_size - 1); // Uniform distribution for random integers
+    EvalCache<T> cache(static_cast<size_t>(cache_mb * 1024 * 1024)); // Fitness cache
+    std::atomic<size_t> evaluations{0}; // Number of fitness evaluations
+    quickopt::Monitor monitor; // Stats and records of the run
+    quickopt::Monitor* observer = python_monitor(monitor, full_output, callback, callback_every); // Monitor passed to the engine, or null
+    quickopt::Stats* stats = quickopt::stats_of(observer); // Per-phase timers, or null
+    quickopt::Checkpoint saves; // Where and how often the run is saved
+    const quickopt::Checkpoint* saved = python_checkpoint(saves, checkpoint, checkpoint_every, resume); // Checkpoint passed to the engine, or null
+    quickopt::Termination stopping; // Budgets and convergence tests of the run
+    quickopt::Termination* stop = python_termination(stopping, max_evaluations, max_time, target, patience, tolerance, min_diversity); // Termination tests passed to the engine, or null
 
-    // Populate initial population
-    while (population.size() < population_size) { // While the population is not full...
-        if (!seed.empty() && population.size() < seed.size()) { // If there are parameters within the seed...
-            population.emplace_back(seed[population.size()], fitness); // Add those parameters to the population as an individual (using emplace_back)
-        } else {
-            population.emplace_back(generate().template cast<std::vector<T>>(), fitness);  // Generate random parameters and add them to the population as an individual
+    // Return the best parameters, with the run information if it was asked for
+    auto result = [&](const std::vector<T>& best) -> py::object {
+        if (!full_output) { // If only the parameters were asked for...
+            return result_params(best);
         }
-    }
+        py::dict info; // Run information
+        info["evaluations"] = evaluations.load(); // Number of fitness evaluations
+        info["cache_hits"] = cache.hits(); // Number of fitness values found in the cache
+        info["cache_misses"] = cache.misses(); // Number of fitness values not found in the cache
+        info["stats"] = stats_dict(monitor.stats); // Time spent in each phase, and the number of fitness evaluations
+        info["stop_reason"] = quickopt::stop_reason_name(stopping.reason()); // Criterion that ended the run
+        return py::make_tuple(result_params(best), info);
+    };
 
-    // Crossover function, taking in two individuals as well as distance and random number generator functions
-    auto crossover = [&dist, &rng](const Individual& father, const Individual& mother) {
+    GeneticOperators<T> operators = genetic_operators<T>(mutate, crossover, crossover_params, mutation_params); // Crossover and mutation operators
+    EvalCache<T>* fitness_cache = cache.enabled() ? &cache : nullptr; // Fitness cache, if it is enabled
+    auto generate_params = [&generate]() { return generate().template cast<std::vector<T>>(); }; // Generate random parameters
 
-        if (father.params.size() != mother.params.size()) { // If the father and mother have different numbers of parameters...
-            throw std::invalid_argument("Father and mother must have the same number of parameters!"); // Throw an exception
+    // Evaluate the fitness of n rows of dim parameters with a Python fitness function, one individual at a time - may be called from island threads without the GIL
+    auto evaluate_python = [&](const T* genomes, size_t n, size_t dim, double* values) {
+        evaluations += n;
+        for (size_t i = 0; i < n; ++i) { // For each individual...
+            py::gil_scoped_acquire acquire;
+            py::object params; // Genome as passed to the fitness function
+            {
+                PhaseTimer timer(stats, Phase::marshalling);
+                params = objective_params(genomes + i * dim, dim);
+            }
+            py::object returned = fitness(params); // Calculate its fitness value, passing a view of its genome
+            PhaseTimer timer(stats, Phase::marshalling);
+            values[i] = returned.template cast<double>();
         }
+    };
 
-        size_t param_len = father.params.size(); // Get the number of parameters of the parents
-        int split = dist(rng) % param_len; // Randomly select a split point for the crossover
-        std::vector<T> child_params; // Create a vector to store the child's parameters
-        child_params.reserve(param_len); // Reserve space for the child's parameters based on the number of parameters of the parents
-        for (size_t i = 0; i < param_len; ++i) { // For each specific parameter value...
-            child_params.push_back(i < split ? father.params[i] : mother.params[i]); // Add the parameter value from the father/mother, depending on index
+    // Evaluate the fitness of n rows of dim parameters with the native fitness function on the calling thread
+    auto evaluate_native = [&](const T* genomes, size_t n, size_t dim, double* values) {
+        evaluations += n;
+        if constexpr (std::is_same<T, double>::value) { // Native fitness functions take doubles
+            for (size_t i = 0; i < n; ++i) { // For each individual...
+                values[i] = native(genomes + i * dim, dim); // Calculate its fitness value
+            }
         }
-        return child_params; // Return the child's parameters
     };
 
-    auto compare = [](const Individual& a, const Individual& b) { // Lambda function to compare two individuals based on fitness value
-        return a.fitness_value > b.fitness_value; // Return true if the fitness value of individual a is greater than that of individual b
-    };
+    if (islands > 1) { // If the population is split into islands...
+        bool ring = topology == "ring"; // Whether the islands form a ring
+        std::vector<T> best = is_native
+            ? quickopt::genetic_islands<py::gil_scoped_release>(evaluate_native, generate_params, seed, operators, population_size, reproduction_ct, survivor_ct, mutation_rate,
+                                                                generations, verbose, islands, migration_interval, migrants, ring, fitness_cache, observer, saved, stop, rng_seed)
+            : quickopt::genetic_islands<py::gil_scoped_release>(evaluate_python, generate_params, seed, operators, population_size, reproduction_ct, survivor_ct, mutation_rate,
+                                                                generations, verbose, islands, migration_interval, migrants, ring, fitness_cache, observer, saved, stop, rng_seed);
+        return result(best);
+    }
 
-    for (int generation = 0; generation < generations; ++generation) { // For each generation...
-        std::sort(population.begin(), population.end(), compare); // Sort the population based on fitness value
-
-        if (verbose == 1) { // If verbose is set to 1...
-            double total_fitness = std::accumulate( // Calculate the total fitness of the population
-                population.begin(), population.end(), 0.0, // Start with a sum of 0.0
-                [](double sum, const Individual& ind) { return sum + ind.fitness_value; }); // Add the fitness value of each individual to the sum
-            double avg_fitness = total_fitness / population.size(); // Calculate the average fitness of the population  
-            std::cout << "Generation " << generation // Output the generation number
-                      << ": Average Fitness: " << avg_fitness // Output the average fitness
-                      << ", Top Fitness: " << population[0].fitness_value << std::endl; // Output the fitness of the top individual
-        }
-
-        std::vector<Individual> parents(population.begin(), population.begin() + reproduction_ct); // Select the top individuals to be parents based on reproduction_ct
-
-        std::vector<Individual> children; // Create a vector to store the children
-        children.reserve(population_size - survivor_ct); // Reserve space for the children based on the population size and survivor count
-        while (children.size() < (population_size - survivor_ct)) { // While the children vector is not full...
-            int father_idx = dist(rng) % reproduction_ct; // Randomly select an index to get a father
-            int mother_idx = dist(rng) % reproduction_ct; // Randomly select an index to get a mother
-            std::vector<T> new_params = crossover(parents[father_idx], parents[mother_idx]);
-            if (std::uniform_real_distribution<>(0.0, 1.0)(rng) < mutation_rate) { // If the random number is less than the mutation rate...
-                new_params = mutate(new_params).template cast<std::vector<T>>(); // Mutate the child's parameters
+    if (is_native) { // If the fitness function is native...
+        ThreadPool pool(n_threads); // Threads evaluating the native fitness function
+        return result(quickopt::genetic([&](const T* genomes, size_t n, size_t dim, double* values) {
+            evaluations += n;
+            if constexpr (std::is_same<T, double>::value) { // Native fitness functions take doubles
+                py::gil_scoped_release release; // The native fitness function never touches Python
+                pool.parallel_for(n, [&](size_t i, size_t) {
+                    values[i] = native(genomes + i * dim, dim); // Calculate its fitness value
+                });
             }
-
-            children.emplace_back(new_params, fitness); // Adds a child to the children vector by crossing over the selected parents
+        }, generate_params, seed, operators, population_size, reproduction_ct, survivor_ct, mutation_rate, generations, verbose, fitness_cache, observer, saved, stop, rng_seed));
+    }
+    if (n_workers > 0) { // If there are worker processes...
+        if constexpr (std::is_arithmetic<T>::value) { // Worker processes take numbers
+            std::vector<std::vector<T>> initial = quickopt::initial_population<T>(generate_params, seed, population_size); // Initial population, built first to size the workers' slots
+            size_t genome_size = initial.empty() ? 0 : initial[0].size(); // Number of parameters per individual
+            GeneticWorkers<T> workers(fitness, genome_size, n_workers, initial.size()); // Processes evaluating the Python fitness function
+            return result(quickopt::genetic([&](const T* genomes, size_t n, size_t dim, double* values) {
+                evaluations += n;
+                workers.evaluate(n, [&](size_t i) { return genomes + i * dim; }, values); // Calculate their fitness values
+            }, [] { return std::vector<T>(); }, initial, operators, population_size, reproduction_ct, survivor_ct, mutation_rate, generations, verbose, fitness_cache, observer, saved, stop, rng_seed));
         }
+    }
+    return result(quickopt::genetic(evaluate_python, generate_params, seed, operators, population_size, reproduction_ct, survivor_ct, mutation_rate, generations, verbose, fitness_cache, observer, saved, stop, rng_seed));
+}
 
-        std::vector<Individual> survivors(population.begin(), population.begin() + survivor_ct); // Select the top individuals to be survivors based on survivor_ct
+// Ask/tell interface to the genetic algorithm - the caller evaluates each generation, so evaluations can be scheduled however it likes
+// The first ask() returns the initial population, and every later ask() returns the children of the next generation
+template <typename T>
+class GeneticState {
+public:
+    GeneticState(py::object mutate, py::function generate, std::vector<std::vector<T>> seed, int population_size, int reproduction_ct, int survivor_ct, double mutation_rate,
+                 std::string crossover, py::dict crossover_params, py::dict mutation_params)
+        : population(genetic_operators<T>(mutate, crossover, crossover_params, mutation_params), population_size, reproduction_ct, survivor_ct, mutation_rate, quickopt::run_seed(-1)), generate(generate), seed(seed), population_size(population_size) {}
 
-        population.clear(); // Empty the population vector
-        population.reserve(population_size); // Re-reserve space for the population vector
-        population.insert(population.end(), survivors.begin(), survivors.end()); // Add in survivors to the population
-        population.insert(population.end(), children.begin(), children.end()); // Add in children to the population
+    // Return the parameters waiting to be evaluated - breeds a new generation if the last one was told
+    std::vector<std::vector<T>> ask() {
+        if (!pending) { // If the last generation has been evaluated...
+            if (started) { // If the initial population has been evaluated...
+                population.select(); // Select the parents and survivors
+                population.breed(); // Breed the children from the parents
+                first = population.first_child(); // The children are waiting for their fitness values
+            } else { // If not...
+                population.init(quickopt::initial_population<T>([this]() { return generate().template cast<std::vector<T>>(); }, seed, population_size)); // Build the initial population
+                first = 0; // The whole population is waiting for its fitness values
+            }
+            pending = true; // The candidates are now waiting for their fitness values
+        }
+        std::vector<std::vector<T>> candidates; // Parameters waiting to be evaluated
+        candidates.reserve(population.size() - first);
+        for (size_t i = first; i < population.size(); ++i) { // For each candidate...
+            candidates.push_back(population.params(i)); // Copy out its parameters
+        }
+        return candidates; // Return the candidates
+    }
 
+    // Record the fitness values of the parameters returned by the last ask()
+    void tell(const std::vector<double>& fitness) {
+        if (!pending) { // If there is nothing waiting to be evaluated...
+            throw std::logic_error("tell() must follow ask()!"); // Throw an exception
+        }
+        if (fitness.size() != population.size() - first) { // If there is not one fitness value per candidate...
+            throw std::invalid_argument("tell() needs one fitness value per candidate!"); // Throw an exception
+        }
+        std::copy(fitness.begin(), fitness.end(), population.fitness() + first); // Record the fitness values
+        if (started) { // If these were children...
+            generation++; // Count the generation
+        }
+        size_t best = population.best(); // Fittest individual of the evaluated population
+        best_genome = population.params(best); // Keep its parameters, since breeding replaces the population
+        best_value = population.fitness_of(best);
+        started = true; // The initial population has been evaluated
+        pending = false; // Nothing is waiting for fitness values
     }
 
-    return population[0].params; // Return the parameters of the top individual in the final population
+    py::object best_params() const { return result_params(best_genome); } // Parameters of the fittest individual in the last evaluated population
+    double best_fitness() const { return best_value; } // Fitness of the fittest individual in the last evaluated population
+
+    int generations() const { return generation; } // Number of completed generations
+
+private:
+    Population<T> population; // Population being evolved
+    py::function generate; // Generate function - generates a set of parameters to be used in the initial population
+    std::vector<std::vector<T>> seed; // Seed population
+    int population_size; // Population size
+    size_t first = 0; // Row of the first candidate waiting to be evaluated
+    std::vector<T> best_genome; // Parameters of the fittest individual in the last evaluated population
+    double best_value = std::numeric_limits<double>::lowest(); // Fitness of the fittest individual in the last evaluated population
+    bool started = false; // Whether the initial population has been evaluated
+    bool pending = false; // Whether candidates are waiting for their fitness values
+    int generation = 0; // Number of completed generations
+};
+
+// Define an ask/tell optimizer state for a given parameter type
+template <typename T>
+void define_genetic_state(py::module_& m, const char* name, const char* doc) {
+    py::class_<GeneticState<T>>(m, name, doc)
+        .def(py::init<py::object, py::function, std::vector<std::vector<T>>, int, int, int, double, std::string, py::dict, py::dict>(),
+            py::arg("mutate"), // Define the mutation function argument
+            py::arg("generate"), // Define the generation function argument
+            py::arg("seed") = std::vector<std::vector<T>>(), // Define the seed argument
+            py::arg("population_size") = 100, // Define the population size argument with a default value of 100
+            py::arg("reproduction_ct") = 10, // Define the reproduction count argument with a default value of 10
+            py::arg("survivor_ct") = 0, // Define the survivor count argument with a default value of 0
+            py::arg("mutation_rate") = 0.1, // Define the mutation rate argument with a default value of 0.1
+            py::arg("crossover") = "single_point", // Define the crossover argument with a default value of "single_point"
+            py::arg("crossover_params") = py::dict(), // Define the crossover parameters argument
+            py::arg("mutation_params") = py::dict() // Define the mutation parameters argument
+        )
+        .def("ask", &GeneticState<T>::ask, "Returns the parameters waiting to be evaluated")
+        .def("tell", &GeneticState<T>::tell, py::arg("fitness"), "Records the fitness values of the parameters returned by the last ask()")
+        .def_property_readonly("best_params", &GeneticState<T>::best_params) // Define the parameters of the fittest individual
+        .def_property_readonly("best_fitness", &GeneticState<T>::best_fitness) // Define the fitness of the fittest individual
+        .def_property_readonly("generations", &GeneticState<T>::generations); // Define the number of completed generations
 }
 
 PYBIND11_MODULE(genetic, m) { // Define the Python module
@@ -126,6 +402,29 @@ PYBIND11_MODULE(genetic, m) { // Define the Python module
         py::arg("mutation_rate") = 0.1, // Define the mutation rate argument with a default value of 0.1
         py::arg("generations") = 100, // Define the number of generations argument with a default value of 100
         py::arg("verbose") = 1, // Define the verbose argument with a default value of 1
+        py::arg("n_threads") = 1, // Define the number of threads evaluating a native fitness function
+        py::arg("n_workers") = 0, // Define the number of worker processes evaluating a Python fitness function
+        py::arg("crossover") = "single_point", // Define the crossover argument with a default value of "single_point"
+        py::arg("crossover_params") = py::dict(), // Define the crossover parameters argument
+        py::arg("mutation_params") = py::dict(), // Define the mutation parameters argument
+        py::arg("islands") = 1, // Define the number of islands argument with a default value of 1
+        py::arg("migration_interval") = 10, // Define the migration interval argument with a default value of 10
+        py::arg("migrants") = 1, // Define the number of migrants argument with a default value of 1
+        py::arg("topology") = "ring", // Define the migration topology argument with a default value of "ring"
+        py::arg("cache_mb") = 0, // Define the fitness cache size argument with a default value of 0 (disabled)
+        py::arg("full_output") = false, // Define the full output argument with a default value of false
+        py::arg("callback") = py::none(), // Define the per-generation callback with a default value of None
+        py::arg("callback_every") = 1, // Define the number of generations between callbacks with a default value of 1
+        py::arg("checkpoint") = "", // Define the checkpoint file with a default value of "" (not saved)
+        py::arg("checkpoint_every") = 10, // Define the number of generations between saves with a default value of 10
+        py::arg("resume") = false, // Define the resume flag with a default value of false
+        py::arg("max_evaluations") = 0, // Define the evaluation budget with a default value of 0 (no limit)
+        py::arg("max_time") = 0, // Define the time budget in seconds with a default value of 0 (no limit)
+        py::arg("target") = py::none(), // Define the target value with a default value of None
+        py::arg("patience") = 0, // Define the number of generations without improvement with a default value of 0 (never stops)
+        py::arg("tolerance") = 0, // Define the smallest improvement with a default value of 0
+        py::arg("min_diversity") = 0, // Define the population spread threshold with a default value of 0 (never stops)
+        py::arg("rng_seed") = -1, // Define the random number generator seed with a default value of -1 (nondeterministic)
         "Evolves a population of doubles over a number of generations using a fitness function and mutation function" // Define the docstring
     );
 
@@ -141,6 +440,29 @@ PYBIND11_MODULE(genetic, m) { // Define the Python module
         py::arg("mutation_rate") = 0.1, // Define the mutation rate argument with a default value of 0.1
         py::arg("generations") = 100, // Define the number of generations argument with a default value of 100
         py::arg("verbose") = 1, // Define the verbose argument with a default value of 1
+        py::arg("n_threads") = 1, // Define the number of threads evaluating a native fitness function
+        py::arg("n_workers") = 0, // Define the number of worker processes evaluating a Python fitness function
+        py::arg("crossover") = "single_point", // Define the crossover argument with a default value of "single_point"
+        py::arg("crossover_params") = py::dict(), // Define the crossover parameters argument
+        py::arg("mutation_params") = py::dict(), // Define the mutation parameters argument
+        py::arg("islands") = 1, // Define the number of islands argument with a default value of 1
+        py::arg("migration_interval") = 10, // Define the migration interval argument with a default value of 10
+        py::arg("migrants") = 1, // Define the number of migrants argument with a default value of 1
+        py::arg("topology") = "ring", // Define the migration topology argument with a default value of "ring"
+        py::arg("cache_mb") = 0, // Define the fitness cache size argument with a default value of 0 (disabled)
+        py::arg("full_output") = false, // Define the full output argument with a default value of false
+        py::arg("callback") = py::none(), // Define the per-generation callback with a default value of None
+        py::arg("callback_every") = 1, // Define the number of generations between callbacks with a default value of 1
+        py::arg("checkpoint") = "", // Define the checkpoint file with a default value of "" (not saved)
+        py::arg("checkpoint_every") = 10, // Define the number of generations between saves with a default value of 10
+        py::arg("resume") = false, // Define the resume flag with a default value of false
+        py::arg("max_evaluations") = 0, // Define the evaluation budget with a default value of 0 (no limit)
+        py::arg("max_time") = 0, // Define the time budget in seconds with a default value of 0 (no limit)
+        py::arg("target") = py::none(), // Define the target value with a default value of None
+        py::arg("patience") = 0, // Define the number of generations without improvement with a default value of 0 (never stops)
+        py::arg("tolerance") = 0, // Define the smallest improvement with a default value of 0
+        py::arg("min_diversity") = 0, // Define the population spread threshold with a default value of 0 (never stops)
+        py::arg("rng_seed") = -1, // Define the random number generator seed with a default value of -1 (nondeterministic)
         "Evolves a population of integers over a number of generations using a fitness function and mutation function" // Define the docstring
     );
 
@@ -156,6 +478,34 @@ PYBIND11_MODULE(genetic, m) { // Define the Python module
         py::arg("mutation_rate") = 0.1, // Define the mutation rate argument with a default value of 0.1
         py::arg("generations") = 100, // Define the number of generations argument with a default value of 100
         py::arg("verbose") = 1, // Define the verbose argument with a default value of 1
+        py::arg("n_threads") = 1, // Define the number of threads evaluating a native fitness function
+        py::arg("n_workers") = 0, // Define the number of worker processes evaluating a Python fitness function
+        py::arg("crossover") = "single_point", // Define the crossover argument with a default value of "single_point"
+        py::arg("crossover_params") = py::dict(), // Define the crossover parameters argument
+        py::arg("mutation_params") = py::dict(), // Define the mutation parameters argument
+        py::arg("islands") = 1, // Define the number of islands argument with a default value of 1
+        py::arg("migration_interval") = 10, // Define the migration interval argument with a default value of 10
+        py::arg("migrants") = 1, // Define the number of migrants argument with a default value of 1
+        py::arg("topology") = "ring", // Define the migration topology argument with a default value of "ring"
+        py::arg("cache_mb") = 0, // Define the fitness cache size argument with a default value of 0 (disabled)
+        py::arg("full_output") = false, // Define the full output argument with a default value of false
+        py::arg("callback") = py::none(), // Define the per-generation callback with a default value of None
+        py::arg("callback_every") = 1, // Define the number of generations between callbacks with a default value of 1
+        py::arg("checkpoint") = "", // Define the checkpoint file with a default value of "" (not saved)
+        py::arg("checkpoint_every") = 10, // Define the number of generations between saves with a default value of 10
+        py::arg("resume") = false, // Define the resume flag with a default value of false
+        py::arg("max_evaluations") = 0, // Define the evaluation budget with a default value of 0 (no limit)
+        py::arg("max_time") = 0, // Define the time budget in seconds with a default value of 0 (no limit)
+        py::arg("target") = py::none(), // Define the target value with a default value of None
+        py::arg("patience") = 0, // Define the number of generations without improvement with a default value of 0 (never stops)
+        py::arg("tolerance") = 0, // Define the smallest improvement with a default value of 0
+        py::arg("min_diversity") = 0, // Define the population spread threshold with a default value of 0 (never stops)
+        py::arg("rng_seed") = -1, // Define the random number generator seed with a default value of -1 (nondeterministic)
         "Evolves a population of strings over a number of generations using a fitness function and mutation function" // Define the docstring
     );
+
+    // Define ask/tell optimizer states for each parameter type
+    define_genetic_state<double>(m, "GeneticState", "Ask/tell genetic algorithm state to maximize a function of double inputs");
+    define_genetic_state<int>(m, "GeneticStateInt", "Ask/tell genetic algorithm state to maximize a function of integer inputs");
+    define_genetic_state<std::string>(m, "GeneticStateString", "Ask/tell genetic algorithm state to maximize a function of string inputs");
 }
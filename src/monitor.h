@@ -0,0 +1,55 @@
+#pragma once
+
+#include <pybind11/pybind11.h>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#include "quickopt/stats.hpp"
+
+namespace py = pybind11;
+
+// Monitor of a run called from Python - returns null if neither stats nor a callback were asked for, so the optimizer runs without timers
+// The callback receives a list of dicts with the keys "iteration", "best_value", "current_value" and "evaluations", every callback_every iterations
+// and once more when the run ends, in place of the per-iteration output of verbose
+inline quickopt::Monitor* python_monitor(quickopt::Monitor& monitor, bool full_output, py::object callback, int callback_every) {
+    if (callback_every < 1) { // If the callback interval is not positive...
+        throw std::invalid_argument("Callback interval must be at least 1!"); // Throw an exception
+    }
+    if (!callback.is_none()) { // If there is a callback...
+        if (!py::isinstance<py::function>(callback)) { // If it cannot be called...
+            throw std::invalid_argument("Callback must be callable!"); // Throw an exception
+        }
+        monitor.interval = static_cast<size_t>(callback_every);
+        monitor.on_records = [callback](const std::vector<quickopt::IterationRecord>& records) {
+            py::gil_scoped_acquire acquire; // The optimizer may have let go of the GIL
+            py::list batch; // Records passed to the callback
+            for (const auto& record : records) { // For each record...
+                py::dict entry;
+                entry["iteration"] = record.iteration;
+                entry["best_value"] = record.best;
+                entry["current_value"] = record.current;
+                entry["evaluations"] = record.evaluations;
+                batch.append(entry);
+            }
+            callback(batch); // Pass the records on
+        };
+    }
+    return full_output || !callback.is_none() ? &monitor : nullptr;
+}
+
+// Stats of a run as a dict - maps each phase that was entered to {"seconds": total time, "calls": number of timed spans}, and "evaluations" to the number of objective evaluations
+inline py::dict stats_dict(const quickopt::Stats& stats) {
+    py::dict result;
+    for (size_t p = 0; p < static_cast<size_t>(quickopt::Phase::count); ++p) { // For each phase...
+        auto phase = static_cast<quickopt::Phase>(p);
+        if (stats.calls(phase) == 0) { // If it was never entered...
+            continue; // Leave it out
+        }
+        py::dict entry;
+        entry["seconds"] = stats.seconds(phase);
+        entry["calls"] = stats.calls(phase);
+        result[quickopt::phase_name(phase)] = entry;
+    }
+    result["evaluations"] = stats.evaluations();
+    return result;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace py = pybind11;
+
+// Read-only numpy array of shape (rows, cols) viewing values owned by C++, without copying them
+// Unless base owns the values, the view does not keep them alive, so it is only valid until the function it is passed to returns - a function that keeps its parameters must copy them
+template <typename T>
+py::array_t<T> readonly_view(const T* data, size_t rows, size_t cols, py::handle base = py::none()) {
+    py::array_t<T> view({static_cast<py::ssize_t>(rows), static_cast<py::ssize_t>(cols)}, data, base); // A base object stops numpy from copying the values
+    py::detail::array_proxy(view.ptr())->flags &= ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_; // Stop the function from writing through the view
+    return view;
+}
+
+// Read-only numpy array of n values owned by C++ - see above
+template <typename T>
+py::array_t<T> readonly_view(const T* data, size_t n) {
+    py::array_t<T> view(static_cast<py::ssize_t>(n), data, py::none()); // A base object stops numpy from copying the values
+    py::detail::array_proxy(view.ptr())->flags &= ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_; // Stop the function from writing through the view
+    return view;
+}
+
+// Read-only numpy array of shape (rows, cols) taking over values built for a single call, without copying them
+// The array owns the values, so it stays valid after the function returns, even if the function keeps it
+template <typename T>
+py::array_t<T> owning_view(std::vector<T>&& values, size_t rows, size_t cols) {
+    std::vector<T>* owned = new std::vector<T>(std::move(values)); // Values, freed with the array
+    py::capsule base(owned, [](void* p) { delete static_cast<std::vector<T>*>(p); });
+    return readonly_view(owned->data(), rows, cols, base);
+}
+
+// Parameters as passed to a Python objective - a read-only view for doubles, and a list for other types
+template <typename T>
+py::object objective_params(const T* data, size_t n) {
+    if constexpr (std::is_same<T, double>::value) {
+        return readonly_view(data, n);
+    } else {
+        return py::cast(std::vector<T>(data, data + n));
+    }
+}
+
+// Parameters as returned to Python - a numpy array for doubles, and a list for other types
+template <typename T>
+py::object result_params(const std::vector<T>& params) {
+    if constexpr (std::is_same<T, double>::value) {
+        py::array_t<double> result(static_cast<py::ssize_t>(params.size())); // The array owns a copy, so it outlives the optimizer
+        std::copy(params.begin(), params.end(), result.mutable_data());
+        return result;
+    } else {
+        return py::cast(params);
+    }
+}
+
+// Contiguous numpy array argument - arrays and other buffers are taken through the buffer protocol without converting each element, and lists are converted by numpy
+template <typename T>
+using numpy_vector = py::array_t<T, py::array::c_style | py::array::forcecast>;
+
+// Copy a one-dimensional array argument into a vector
+template <typename T>
+std::vector<T> to_vector(const numpy_vector<T>& values) {
+    if (values.ndim() != 1) { // If the values are not a vector...
+        throw std::invalid_argument("Expected a one-dimensional array!"); // Throw an exception
+    }
+    return std::vector<T>(values.data(), values.data() + values.size());
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <pybind11/pybind11.h>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace py = pybind11;
+
+// Signature of a native objective - takes a pointer to the parameters, the number of parameters, and the user data
+typedef double (*native_objective_t)(const double* params, size_t n, void* user_data);
+
+// Native objective - a compiled function that can be called without the GIL, from any thread
+struct NativeObjective {
+    native_objective_t fn = nullptr; // Function to call
+    void* user_data = nullptr; // User data passed to every call
+
+    double operator()(const double* params, size_t n) const { return fn(params, n, user_data); } // Evaluate the objective
+};
+
+// Check whether an objective is native, and if so unpack it - accepts
+//  - a PyCapsule holding the function pointer, with the user data as the capsule's context
+//  - an int holding the function's address (e.g. a numba cfunc's `.address` or a ctypes function pointer cast to int)
+//  - a tuple of two ints holding the function's address and the user data's address
+// Anything else (e.g. a Python function) is not native
+inline bool native_objective(const py::object& funct, NativeObjective& out) {
+    if (PyCapsule_CheckExact(funct.ptr())) { // If the objective is a capsule...
+        out.fn = reinterpret_cast<native_objective_t>(PyCapsule_GetPointer(funct.ptr(), PyCapsule_GetName(funct.ptr()))); // Unpack the function pointer
+        out.user_data = PyCapsule_GetContext(funct.ptr()); // Unpack the user data
+        if (out.fn == nullptr) { // If the capsule held no pointer...
+            throw py::error_already_set(); // Raise the error set by the capsule
+        }
+        return true;
+    }
+    if (PyLong_Check(funct.ptr())) { // If the objective is an address...
+        out.fn = reinterpret_cast<native_objective_t>(static_cast<uintptr_t>(funct.cast<unsigned long long>())); // Unpack the function pointer
+        out.user_data = nullptr; // There is no user data
+    } else if (PyTuple_Check(funct.ptr()) && PyTuple_Size(funct.ptr()) == 2) { // If the objective is an address and user data pair...
+        py::tuple pair = funct.cast<py::tuple>();
+        out.fn = reinterpret_cast<native_objective_t>(static_cast<uintptr_t>(pair[0].cast<unsigned long long>())); // Unpack the function pointer
+        out.user_data = reinterpret_cast<void*>(static_cast<uintptr_t>(pair[1].cast<unsigned long long>())); // Unpack the user data
+    } else { // If not...
+        return false; // The objective is a Python callable
+    }
+    if (out.fn == nullptr) { // If the address is null...
+        throw std::invalid_argument("Native objective address must not be null!"); // Throw an exception
+    }
+    return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <pybind11/pybind11.h>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include "quickopt/alphabet.hpp"
+
+namespace py = pybind11;
+
+// Parameters of a named operator - reads numbers and strings out of a Python dict, and rejects keys the operator does not use
+class OperatorParams {
+public:
+    OperatorParams(const std::string& kind, const std::string& name, const py::dict& params) : kind(kind), name(name) {
+        for (auto item : params) { // For each parameter...
+            values[item.first.cast<std::string>()] = py::reinterpret_borrow<py::object>(item.second); // Keep it until the operator reads it
+        }
+    }
+
+    bool has(const std::string& key) const { return values.count(key) != 0; } // Whether a parameter was given
+
+    // Read a numeric parameter, or its default if it was not given
+    double number(const std::string& key, double fallback) {
+        auto it = values.find(key);
+        if (it == values.end()) { // If it was not given...
+            return fallback; // Use the default
+        }
+        double value = it->second.cast<double>();
+        values.erase(it); // Mark it as used
+        return value;
+    }
+
+    // Read a string parameter, or its default if it was not given
+    std::string text(const std::string& key, const std::string& fallback) {
+        auto it = values.find(key);
+        if (it == values.end()) { // If it was not given...
+            return fallback; // Use the default
+        }
+        std::string value = it->second.cast<std::string>();
+        values.erase(it); // Mark it as used
+        return value;
+    }
+
+    // Check every parameter was used by the operator
+    void finish() const {
+        if (!values.empty()) { // If a parameter was not used...
+            throw std::invalid_argument("Unknown parameter \"" + values.begin()->first + "\" for " + kind + " \"" + name + "\"!"); // Throw an exception
+        }
+    }
+
+private:
+    std::string kind; // Kind of operator, for error messages
+    std::string name; // Name of the operator, for error messages
+    std::map<std::string, py::object> values; // Parameters not yet read
+};
+
+using quickopt::printable_ascii;
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "numpy_view.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define QUICKOPT_PROCESS_POOL 1
+#endif
+
+namespace py = pybind11;
+
+// Pool of forked worker processes for evaluating a Python function on several cores - each worker has its own interpreter, so the GIL is never shared
+// Parameters and values are exchanged through a shared-memory buffer, so nothing is pickled; each batch is started and finished with one byte per worker over pipes
+template <typename T>
+class ProcessPool {
+public:
+    static_assert(std::is_arithmetic<T>::value, "worker processes only support numeric parameters"); // Parameters are stored in shared memory
+
+    // Fork n_workers workers evaluating funct on sets of dim parameters, with room for capacity sets per round
+    ProcessPool(py::object funct, size_t dim, int n_workers, size_t capacity) : dim(dim), capacity(std::max<size_t>(capacity, 1)) {
+#ifdef QUICKOPT_PROCESS_POOL
+        // Map the shared buffer - a header followed by the parameters and values of every slot
+        bytes = sizeof(Header) + this->capacity * dim * sizeof(T) + this->capacity * sizeof(double); // Size of the shared buffer
+        void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0); // Map anonymous memory shared with the children
+        if (memory == MAP_FAILED) { // If the mapping failed...
+            throw std::runtime_error("Could not map shared memory for the worker processes!"); // Throw an exception
+        }
+        header = new (memory) Header(); // Construct the header in the shared buffer
+        params = reinterpret_cast<T*>(static_cast<char*>(memory) + sizeof(Header)); // Parameters of every slot
+        values = reinterpret_cast<double*>(params + this->capacity * dim); // Values of every slot
+
+        flush_output(); // Flush buffered output so the workers do not repeat it
+        for (int w = 0; w < n_workers; ++w) { // For each worker...
+            int go[2], done[2]; // Pipes to start a round and to report it finished
+            if (pipe(go) != 0) { // If the pipe could not be created...
+                shutdown(); // Stop the workers started so far
+                throw std::runtime_error("Could not create pipes for the worker processes!"); // Throw an exception
+            }
+            if (pipe(done) != 0) { // If the pipe could not be created...
+                close(go[0]);
+                close(go[1]);
+                shutdown(); // Stop the workers started so far
+                throw std::runtime_error("Could not create pipes for the worker processes!"); // Throw an exception
+            }
+            PyOS_BeforeFork(); // Let the interpreter prepare for the fork
+            pid_t pid = fork(); // Fork the worker
+            if (pid == 0) { // If this is the worker...
+                PyOS_AfterFork_Child(); // Let the interpreter reinitialize itself
+                close(go[1]); // Close the parent's ends of the pipes
+                close(done[0]);
+                for (const Worker& other : workers) { // For each worker forked before this one...
+                    close(other.go); // Close the inherited ends of its pipes, so the parent sees it exit
+                    close(other.done);
+                }
+                work(funct, go[0], done[1]); // Evaluate rounds until told to stop
+            }
+            PyOS_AfterFork_Parent(); // Let the interpreter resume in the parent
+            close(go[0]); // Close the worker's ends of the pipes
+            close(done[1]);
+            if (pid < 0) { // If the fork failed...
+                close(go[1]);
+                close(done[0]);
+                shutdown(); // Stop the workers started so far
+                throw std::runtime_error("Could not fork the worker processes!"); // Throw an exception
+            }
+            workers.push_back({pid, go[1], done[0]}); // Keep track of the worker
+        }
+#else
+        (void)funct;
+        (void)n_workers;
+        throw std::invalid_argument("Worker processes are only supported on POSIX systems!"); // Throw an exception
+#endif
+    }
+
+    ~ProcessPool() { shutdown(); }
+
+    ProcessPool(const ProcessPool&) = delete;
+    ProcessPool& operator=(const ProcessPool&) = delete;
+
+    size_t size() const { return workers.size(); } // Number of worker processes
+
+    // Evaluate n sets of parameters, where row(i) points to the i-th set, storing the value of each in out
+    // Sets are sent in rounds of up to capacity; blocks until every value is back, with the GIL released while waiting
+    template <typename Row>
+    void evaluate(size_t n, Row row, double* out) {
+#ifdef QUICKOPT_PROCESS_POOL
+        for (size_t start = 0; start < n; start += capacity) { // For each round...
+            size_t count = std::min(capacity, n - start); // Number of sets in this round
+            for (size_t i = 0; i < count; ++i) { // For each set in the round...
+                const T* p = row(start + i);
+                std::copy(p, p + dim, params + i * dim); // Copy it into its slot
+            }
+            header->count = count;
+            header->next.store(0); // Let the workers take slots from the start
+            header->failed.store(0);
+
+            {
+                py::gil_scoped_release release; // Let other Python threads run while the workers evaluate
+                bool lost = false; // Whether a worker exited unexpectedly
+                for (const Worker& worker : workers) { // For each worker...
+                    char command = 1;
+                    if (write_byte(worker.go, command) != 1) { // Start the round
+                        lost = true;
+                    }
+                }
+                for (const Worker& worker : workers) { // For each worker...
+                    char reply;
+                    if (read_byte(worker.done, reply) != 1) { // Wait for it to finish the round
+                        lost = true;
+                    }
+                }
+                if (lost) { // If a worker is gone...
+                    throw std::runtime_error("A worker process exited unexpectedly!"); // Throw an exception
+                }
+            }
+
+            if (header->failed.load()) { // If the function raised in a worker...
+                throw std::runtime_error(std::string("Function raised in a worker process: ") + header->error); // Throw an exception
+            }
+            std::copy(values, values + count, out + start); // Collect the values of the round
+        }
+#else
+        (void)n;
+        (void)row;
+        (void)out;
+#endif
+    }
+
+private:
+#ifdef QUICKOPT_PROCESS_POOL
+    // Header of the shared buffer
+    struct Header {
+        std::atomic<size_t> next{0}; // Next slot to take in the current round
+        size_t count = 0; // Number of slots in the current round
+        std::atomic<int> failed{0}; // Whether the function raised in the current round
+        char error[256] = {}; // Message of the first exception raised
+    };
+
+    // Handle on a worker process
+    struct Worker {
+        pid_t pid; // Process id
+        int go; // Write end of the pipe starting a round
+        int done; // Read end of the pipe reporting a round finished
+    };
+
+    // Write a single byte - if the reader exited this fails with EPIPE, since Python ignores SIGPIPE
+    static ssize_t write_byte(int fd, char byte) {
+        ssize_t r;
+        do { r = write(fd, &byte, 1); } while (r < 0 && errno == EINTR); // Retry if interrupted by a signal
+        return r;
+    }
+
+    // Read a single byte - returns 0 if the writer exited
+    static ssize_t read_byte(int fd, char& byte) {
+        ssize_t r;
+        do { r = read(fd, &byte, 1); } while (r < 0 && errno == EINTR); // Retry if interrupted by a signal
+        return r;
+    }
+
+    // Flush the output buffers of C++ and of Python's sys.stdout and sys.stderr - needs the GIL
+    static void flush_output() {
+        std::cout.flush();
+        std::cerr.flush();
+        py::module_ sys = py::module_::import("sys");
+        for (const char* name : {"stdout", "stderr"}) { // For each of Python's output streams...
+            py::object stream = sys.attr(name);
+            if (stream.is_none()) { // If it was closed or never set up...
+                continue;
+            }
+            try {
+                stream.attr("flush")();
+            } catch (py::error_already_set&) { // If it cannot be flushed, there is nothing to keep
+            }
+        }
+    }
+
+    // Worker loop - evaluate slots of each round until the parent sends a stop byte or goes away, then exit without unwinding the interpreter
+    [[noreturn]] void work(py::object& funct, int go, int done) {
+        char command;
+        while (read_byte(go, command) == 1 && command != 0) { // While there are rounds to evaluate...
+            for (size_t i = header->next.fetch_add(1); i < header->count; i = header->next.fetch_add(1)) { // For each slot not yet taken...
+                try {
+                    values[i] = funct(objective_params(params + i * dim, dim)).template cast<double>(); // Evaluate the function on the parameters in the slot
+                } catch (const std::exception& e) {
+                    if (header->failed.exchange(1) == 0) { // If this is the first exception of the round...
+                        std::strncpy(header->error, e.what(), sizeof(header->error) - 1); // Record its message
+                    }
+                    header->next.store(header->count); // Skip the remaining slots
+                }
+            }
+            if (write_byte(done, command) != 1) { // Report the round finished
+                break;
+            }
+        }
+        flush_output(); // Write out what the function printed, since _exit discards buffered output - the worker still holds the GIL it inherited
+        _exit(0);
+    }
+
+    // Stop every worker and unmap the shared buffer
+    void shutdown() {
+        for (const Worker& worker : workers) { // For each worker...
+            write_byte(worker.go, 0); // Tell it to exit
+            close(worker.go);
+            close(worker.done);
+        }
+        for (const Worker& worker : workers) { // For each worker...
+            while (waitpid(worker.pid, nullptr, 0) < 0 && errno == EINTR) {} // Reap it
+        }
+        workers.clear();
+        if (header != nullptr) { // If the buffer is mapped...
+            header->~Header();
+            munmap(header, bytes); // Unmap it
+            header = nullptr;
+        }
+    }
+
+    std::vector<Worker> workers; // Worker processes
+    Header* header = nullptr; // Header of the shared buffer
+    size_t bytes = 0; // Size of the shared buffer
+    T* params = nullptr; // Parameters of every slot, one row of dim per slot
+    double* values = nullptr; // Value of every slot
+#else
+    void shutdown() {}
+#endif
+    size_t dim; // Number of parameters per set
+    size_t capacity; // Number of slots per round
+};
@@ -1,136 +1,201 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/numpy.h>
 #include <iostream>
 #include <cmath>
 #include <algorithm>
 #include <random>
 #include <stdexcept>
+#include <string>
 #include <vector>
 #include <limits>
+#include <memory>
 #include <type_traits>
+#include "checkpoint.h"
+#include "monitor.h"
+#include "numpy_view.h"
+#include "objective.h"
+#include "process_pool.h"
+#include "termination.h"
+#include "quickopt/pso.hpp"
 
 namespace py = pybind11;
+using quickopt::Phase;
+using quickopt::PhaseTimer;
+using quickopt::Swarm;
+
+// Copy the positions of the whole swarm into a new (swarm_size, dim) array
+template <typename T>
+py::array_t<T> swarm_array(const Swarm<T>& swarm) {
+    py::array_t<T> matrix({static_cast<py::ssize_t>(swarm.size()), static_cast<py::ssize_t>(swarm.dimension())}); // Create a (swarm_size, dim) array to hold the swarm
+    std::copy(swarm.positions(), swarm.positions() + swarm.size() * swarm.dimension(), matrix.mutable_data()); // Copy the positions into the array
+    return matrix;
+}
+
+// Convert the values of a whole swarm of n particles to a contiguous array of doubles, checking there is one per particle
+inline py::array_t<double, py::array::c_style | py::array::forcecast> swarm_values(size_t n, py::object values) {
+    auto result = values.template cast<py::array_t<double, py::array::c_style | py::array::forcecast>>(); // Convert the result to a contiguous array of doubles
+    if (result.size() != static_cast<py::ssize_t>(n)) { // If there is not one value per particle...
+        throw std::invalid_argument("Batch function must return one value per particle!"); // Throw an exception
+    }
+    return result;
+}
 
 // Simulated particle swarm optimization function - ONLY WORKS FOR DOUBLES!
+// Adapts a Python function or native objective to the engines in quickopt/pso.hpp
 template <typename T>
-std::vector<T> pso(
-    py::function funct, // The function to be *maximized*
-    std::vector<T> space_min, // Lower bound vector for the search space
-    std::vector<T> space_max, // Upper bound vector for the search space
+py::object pso(
+    py::object funct, // The function to be *maximized* - a Python function, or a native objective (see objective.h)
+    numpy_vector<T> space_min, // Lower bound vector for the search space
+    numpy_vector<T> space_max, // Upper bound vector for the search space
     int iterations = 100,  // Number of iterations to run the algorithm for
     int swarm_size = 100, // Number of particles in the swarm
     double inertia = 0.5, // Inertia weight - recommended be in (0,1)
     double cognitive = 1.0, // Cognitive weight - recommended be in [1,3]
     double social = 2.0, // Social weight - recommended be in [1,3]
     double clamp = 0.1, // Clamping limit on velocity
-    int verbose = 1 // Verbosity level - 0 for final output, 1 for output at each iteration
+    int verbose = 1, // Verbosity level - 0 for final output, 1 for output at each iteration
+    bool batch = false, // Batch mode - if true, funct takes the whole swarm as a (swarm_size, dim) array and returns an array of values
+    int n_threads = 1, // Number of threads evaluating a native objective - 0 uses every hardware thread
+    int n_workers = 0, // Number of worker processes evaluating a Python function - 0 evaluates it in this process
+    bool full_output = false, // Whether to also return a dict of run information
+    py::object callback = py::none(), // Function receiving lists of per-iteration records in place of the per-iteration output
+    int callback_every = 1, // Number of iterations between calls to the callback
+    std::string checkpoint = "", // File the state of the run is saved to - empty for none
+    int checkpoint_every = 10, // Number of iterations between saves
+    bool resume = false, // Whether to continue the run saved in checkpoint, if the file exists
+    long long max_evaluations = 0, // Number of evaluations after which the run stops - 0 for no limit
+    double max_time = 0, // Number of seconds after which the run stops - 0 for no limit
+    py::object target = py::none(), // Best value at which the run stops - None for none
+    int patience = 0, // Number of iterations without improvement after which the run stops - 0 to never stop
+    double tolerance = 0, // Smallest improvement of the best value that resets the patience
+    double min_diversity = 0, // Spread of the swarm below which the run stops - 0 to never stop
+    long long rng_seed = -1 // Seed for the random number generator - negative for a nondeterministic seed
 ) {
 
-    // Warn unusual inputs
-    if (inertia <= 0 || inertia >= 1) {  // If the inertia is outside the suggested limits...
-        std::cerr << "Inertia outside suggested limits! Recommended be in (0,1)" << std::endl; // Prints a warning message
+    NativeObjective native; // Native objective, if funct is one
+    bool is_native = native_objective(funct, native); // Whether funct is a native objective
+
+    // Check for invalid inputs
+    if (is_native && batch) { // If a native objective was given in batch mode...
+        throw std::invalid_argument("Batch mode requires a Python function!"); // Throw an exception
     }
-    if (cognitive < 1 || cognitive > 3) { // If the cognitive factor is outside the suggested limits...
-        std::cerr << "Cognition factor outside suggested limits! Recommended be in [1,3]" << std::endl; // Prints a warning message
+    if (n_threads < 0) { // If the number of threads is negative...
+        throw std::invalid_argument("Number of threads must be non-negative!"); // Throw an exception
     }
-    if (social < 1 || social > 3) { // If the social factor is outside the suggested limits...
-        std::cerr << "Social factor outside suggested limits! Recommended be in [1,3]" << std::endl; // Prints a warning message
+    if (n_workers < 0) { // If the number of worker processes is negative...
+        throw std::invalid_argument("Number of workers must be non-negative!"); // Throw an exception
+    }
+    if (n_workers > 0 && (is_native || batch)) { // If worker processes were requested for a native objective or in batch mode...
+        throw std::invalid_argument("Worker processes require a Python function evaluated one particle at a time!"); // Throw an exception
     }
-
-    // Check for invalid inputs
     if (space_min.size() != space_max.size()) { // If the space minimum and maximum vectors are not the same size...
         throw std::invalid_argument("Search space vectors must be of same size!"); // Throw an exception
     }
 
-    // Particle class - represents each particle in the swarm, storing its parameters (position), velocity, and value
-    class Particle {
-    public:
-        std::vector<T> position; // Position of each particle 
-        std::vector<T> velocity; // Velocity of each particle
-
-        std::vector<T> pb_pos; // Personal best position of each particle
-
-        double value; // Value of each particle
-
-        double pb_val; // Personal best value of each particle
-        
-        // Constructor to initialize position, velocity, and value
-        Particle(const std::vector<T>& p, const std::vector<T>& v, double val)
-            : position(p), velocity(v), pb_pos(p), value(val), pb_val(val) {}
-    };
-
-    // Initialize the swarm
-    std::vector<Particle> swarm; // Vector to store the particles in the swarm
-    std::mt19937 rng(std::random_device{}()); // Random number generator
-    std::uniform_real_distribution<> dist_space(0.0, 1.0); // Uniform distribution for initial space
-    std::uniform_real_distribution<> dist_velocity(-clamp, clamp); // Uniform distribution for initial velocity
-    std::uniform_real_distribution<> dist_inertia(0.0, 1.0); // Uniform distribution for random factors
-
-    std::vector<T> gb_pos; // Initialize the global best position value
-    double gb_val = std::numeric_limits<double>::lowest(); // Initialize the global best value
-
-    // Initialize the particles
-    for (int i = 0; i < swarm_size; ++i) { // For every proposed particle in swarm size...
-        std::vector<T> position; // Create a vector to store position
-        for (int j = 0; j < space_min.size(); ++j) { // For every individual parameter in the function...
-            position.push_back(space_min[j] + dist_space(rng) * (space_max[j] - space_min[j])); // Generate a random position (input) parameter within the search space
-        }
-        std::vector<T> velocity; // Create a vector to store velocity
-        for (int j = 0; j < space_min.size(); ++j) { // For every individual parameter in the function...
-            velocity.push_back(dist_velocity(rng)); // Generate a random velocity parameter within the clamping limit
-        }
-
-        double value = funct(position).template cast<double>(); // Calculate the value of the particle
-        
-        if(value > gb_val) { // If the value is greater than the global best...
-            gb_val = value; // Update the global best value
-            gb_pos = position; // Update the global best position
-        }
-
-        swarm.push_back(Particle(position, velocity, value)); // Add the particle to the swarm
-    }
-
-    // Run the optimization 
-    for (int i = 0; i < iterations; ++i){ // For every iteration...
-        for (auto& particle : swarm) { // For each particle in the swarm...
-            std::vector<T> proposed_velocity; // Create a vector to store the new velocity
-            std::vector<T> proposed_position; // Create a vector to store the new position
-
-            // Generate a new velocity for the particle, and then generate the particle's proposed position based off it
-            for (int j = 0; j < space_min.size(); ++j) { // For every individual parameter in the function...
-                double r1 = dist_inertia(rng); // Generate a random factor r1
-                double r2 = dist_inertia(rng); // Generate a random factor r2
-                double proposed_velo_param = inertia * particle.velocity[j] + cognitive * r1 * (particle.pb_pos[j] - particle.position[j]) + social * r2 * (gb_pos[j] - particle.position[j]); // Calculate the new velocity parameter based on the velocity formula
-                proposed_velocity.push_back(std::min(std::max(proposed_velo_param, -clamp), clamp)); // Update the velocity by adding the new velocity parameter and using clamping limit
-
-                double proposed_pos_param = particle.position[j] + proposed_velocity[j]; // Calculate the new position parameter based on the velocity
-                proposed_position.push_back(std::min(std::max(proposed_pos_param, space_min[j]), space_max[j])); // Update the position by adding the new position parameter and using search space limits
+    std::vector<T> lower = to_vector(space_min); // Lower bound vector for the search space
+    std::vector<T> upper = to_vector(space_max); // Upper bound vector for the search space
+    std::vector<T> best; // Global best position
+    quickopt::Monitor monitor; // Stats and records of the run
+    quickopt::Monitor* observer = python_monitor(monitor, full_output, callback, callback_every); // Monitor passed to the engine, or null
+    quickopt::Stats* stats = quickopt::stats_of(observer); // Per-phase timers, or null
+    quickopt::Checkpoint saves; // Where and how often the run is saved
+    const quickopt::Checkpoint* saved = python_checkpoint(saves, checkpoint, checkpoint_every, resume); // Checkpoint passed to the engine, or null
+    quickopt::Termination stopping; // Budgets and convergence tests of the run
+    quickopt::Termination* stop = python_termination(stopping, max_evaluations, max_time, target, patience, tolerance, min_diversity); // Termination tests passed to the engine, or null
+
+    if (is_native) { // If the objective is native...
+        // Evaluate the whole swarm each iteration, spreading the particles over the threads without holding the GIL
+        best = quickopt::pso_parallel<py::gil_scoped_release>(native, lower, upper, iterations, swarm_size, inertia, cognitive, social, clamp, verbose, n_threads, observer, saved, stop, rng_seed);
+    } else if (n_workers > 0) { // If there are worker processes...
+        ProcessPool<T> workers(funct, lower.size(), n_workers, static_cast<size_t>(std::max(swarm_size, 0))); // Processes evaluating the function
+        // Evaluate the whole swarm each iteration on the workers
+        best = quickopt::pso_synchronous([&](const T* positions, size_t n, size_t dim, double* values) {
+            workers.evaluate(n, [&](size_t p) { return positions + p * dim; }, values); // Calculate the value of every particle
+        }, lower, upper, iterations, swarm_size, inertia, cognitive, social, clamp, verbose, observer, saved, stop, rng_seed);
+    } else if (batch) { // If the function takes the whole swarm...
+        // Evaluate the whole swarm each iteration with a single call, passing a view of the positions
+        best = quickopt::pso_synchronous([&](const T* positions, size_t n, size_t dim, double* values) {
+            py::object view; // View of the positions
+            {
+                PhaseTimer timer(stats, Phase::marshalling);
+                view = readonly_view(positions, n, dim);
             }
+            py::object returned = funct(view); // Evaluate the swarm
+            PhaseTimer timer(stats, Phase::marshalling);
+            auto result = swarm_values(n, returned); // Convert the values
+            std::copy(result.data(), result.data() + n, values); // Store the value of every particle
+        }, lower, upper, iterations, swarm_size, inertia, cognitive, social, clamp, verbose, observer, saved, stop, rng_seed);
+    } else { // If not...
+        // Evaluate one particle at a time, passing a view of its position
+        best = quickopt::pso([&](const T* params, size_t dim) {
+            py::object view; // View of the position
+            {
+                PhaseTimer timer(stats, Phase::marshalling);
+                view = readonly_view(params, dim);
+            }
+            py::object returned = funct(view); // Calculate the value of the particle
+            PhaseTimer timer(stats, Phase::marshalling);
+            return returned.template cast<double>();
+        }, lower, upper, iterations, swarm_size, inertia, cognitive, social, clamp, verbose, observer, saved, stop, rng_seed);
+    }
 
-            double new_value = funct(proposed_position).template cast<double>(); // Calculate the value of the new position
-
-            particle.value = new_value; // Update the particle's value
-            particle.velocity = proposed_velocity; // Update the velocity
-            particle.position = proposed_position; // Update the particle's position
+    if (!full_output) { // If only the position was asked for...
+        return result_params(best); // Return the global best position
+    }
+    py::dict info; // Run information
+    info["stats"] = stats_dict(monitor.stats); // Time spent in each phase, and the number of evaluations
+    info["stop_reason"] = quickopt::stop_reason_name(stopping.reason()); // Criterion that ended the run
+    return py::make_tuple(result_params(best), info); // Return the global best position and the run information
+}
 
-            if (new_value > particle.pb_val) { // If the new value is greater than the current personal best value...
-                particle.pb_pos = proposed_position; // Update the personal best position
-                particle.pb_val = new_value; // Update the personal best value
-                if (new_value > gb_val) { // If the new value is greater than the global best value...
-                    gb_val = new_value; // Update the global best value
-                    gb_pos = proposed_position; // Update the global best position
+// Ask/tell interface to particle swarm optimization - the caller evaluates the swarm, so evaluations can be scheduled however it likes
+// Each ask() returns the swarm's pending positions, and each tell() consumes their values; moves are synchronous, as in batch mode
+template <typename T>
+class PSOState {
+public:
+    PSOState(numpy_vector<T> space_min, numpy_vector<T> space_max, int swarm_size, double inertia, double cognitive, double social, double clamp)
+        : swarm(to_vector(space_min), to_vector(space_max), swarm_size, inertia, cognitive, social, clamp, quickopt::run_seed(-1)) {}
+
+    // Return the positions waiting to be evaluated as a (swarm_size, dim) array - moves the swarm first if the last positions were told
+    py::array_t<T> ask() {
+        if (!pending) { // If the last positions have been evaluated...
+            if (started) { // If the swarm has been evaluated before...
+                for (size_t p = 0; p < swarm.size(); ++p) { // For each particle in the swarm...
+                    swarm.move(p); // Move the particle
                 }
             }
+            pending = true; // The positions are now waiting for their values
         }
+        return swarm_array(swarm); // Return the positions
+    }
 
-        if (verbose == 1) { // If the user wants verbose output...
-            std::cout << "Iteration: " << i << " Current Best: " << gb_val << std::endl; // Output the global best value
+    // Record the values of the positions returned by the last ask()
+    void tell(py::object values) {
+        if (!pending) { // If there is nothing waiting to be evaluated...
+            throw std::logic_error("tell() must follow ask()!"); // Throw an exception
+        }
+        auto result = swarm_values(swarm.size(), values); // Convert the values to a contiguous array of doubles
+        for (size_t p = 0; p < swarm.size(); ++p) { // For each particle in the swarm...
+            swarm.update(p, result.data()[p]); // Update the particle's value and bests
+        }
+        if (started) { // If these were moved positions...
+            iteration++; // Count the iteration
         }
+        started = true; // The swarm has been evaluated
+        pending = false; // Nothing is waiting for values
     }
 
-    std::cout << "Best Value: " << gb_val << std::endl; // Output the global best value
-    return gb_pos; // Return the global best position
-}
+    py::object best_params() const { return result_params(swarm.best_position()); } // Global best position
+    double best_value() const { return swarm.best_value(); } // Global best value
+    int iterations() const { return iteration; } // Number of completed iterations, not counting the initial evaluation
+
+private:
+    Swarm<T> swarm; // Swarm being optimized
+    bool started = false; // Whether the initial positions have been evaluated
+    bool pending = false; // Whether positions are waiting for their values
+    int iteration = 0; // Number of completed iterations
+};
 
 PYBIND11_MODULE(pso, m) { // Define the Python module
 
@@ -146,6 +211,39 @@ PYBIND11_MODULE(pso, m) { // Define the Python module
         py::arg("social") = 2.0, // Define the social weight
         py::arg("clamp") = 0.1, // Define the clamping limit on velocity
         py::arg("verbose") = 1, // Define the verbosity with a default value of 1
+        py::arg("batch") = false, // Define the batch evaluation mode with a default value of false
+        py::arg("n_threads") = 1, // Define the number of threads evaluating a native objective
+        py::arg("n_workers") = 0, // Define the number of worker processes evaluating a Python function
+        py::arg("full_output") = false, // Define the full output flag with a default value of false
+        py::arg("callback") = py::none(), // Define the per-iteration callback with a default value of None
+        py::arg("callback_every") = 1, // Define the number of iterations between callbacks with a default value of 1
+        py::arg("checkpoint") = "", // Define the checkpoint file with a default value of "" (not saved)
+        py::arg("checkpoint_every") = 10, // Define the number of iterations between saves with a default value of 10
+        py::arg("resume") = false, // Define the resume flag with a default value of false
+        py::arg("max_evaluations") = 0, // Define the evaluation budget with a default value of 0 (no limit)
+        py::arg("max_time") = 0, // Define the time budget in seconds with a default value of 0 (no limit)
+        py::arg("target") = py::none(), // Define the target value with a default value of None
+        py::arg("patience") = 0, // Define the number of iterations without improvement with a default value of 0 (never stops)
+        py::arg("tolerance") = 0, // Define the smallest improvement with a default value of 0
+        py::arg("min_diversity") = 0, // Define the swarm spread threshold with a default value of 0 (never stops)
+        py::arg("rng_seed") = -1, // Define the random number generator seed with a default value of -1 (nondeterministic)
         "Uses particle swarm optimization to maximize a function of double inputs" // Define the docstring
     );
+
+    // Define an ask/tell optimizer state for functions of doubles
+    py::class_<PSOState<double>>(m, "PSOState")
+        .def(py::init<numpy_vector<double>, numpy_vector<double>, int, double, double, double, double>(),
+            py::arg("space_min"), // Define the lower bounds of the search space
+            py::arg("space_max"), // Define the upper bounds of the search space
+            py::arg("swarm_size") = 100, // Define the number of particles in the swarm
+            py::arg("inertia") = 0.5, // Define the inertia weight
+            py::arg("cognitive") = 1.0, // Define the cognitive weight
+            py::arg("social") = 2.0, // Define the social weight
+            py::arg("clamp") = 0.1 // Define the clamping limit on velocity
+        )
+        .def("ask", &PSOState<double>::ask, "Returns the swarm positions waiting to be evaluated as a (swarm_size, dim) array")
+        .def("tell", &PSOState<double>::tell, py::arg("values"), "Records the values of the positions returned by the last ask()")
+        .def_property_readonly("best_params", &PSOState<double>::best_params) // Define the global best position
+        .def_property_readonly("best_value", &PSOState<double>::best_value) // Define the global best value
+        .def_property_readonly("iterations", &PSOState<double>::iterations); // Define the number of completed iterations
 }
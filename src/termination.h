@@ -0,0 +1,36 @@
+#pragma once
+
+#include <pybind11/pybind11.h>
+#include <limits>
+#include <stdexcept>
+#include "quickopt/termination.hpp"
+
+namespace py = pybind11;
+
+// Termination tests of a run called from Python - returns null if every budget and test is off, so the run goes through all its iterations
+// target is None or the value at which the run stops, in the optimizer's own sense
+inline quickopt::Termination* python_termination(quickopt::Termination& termination, long long max_evaluations, double max_time, py::object target, int patience, double tolerance, double min_diversity = 0) {
+    if (max_evaluations < 0) { // If the evaluation budget is negative...
+        throw std::invalid_argument("Maximum number of evaluations must be non-negative!"); // Throw an exception
+    }
+    if (max_time < 0) { // If the time budget is negative...
+        throw std::invalid_argument("Maximum time must be non-negative!"); // Throw an exception
+    }
+    if (patience < 0) { // If the patience is negative...
+        throw std::invalid_argument("Patience must be non-negative!"); // Throw an exception
+    }
+    if (tolerance < 0) { // If the tolerance is negative...
+        throw std::invalid_argument("Tolerance must be non-negative!"); // Throw an exception
+    }
+    if (min_diversity < 0) { // If the diversity threshold is negative...
+        throw std::invalid_argument("Diversity threshold must be non-negative!"); // Throw an exception
+    }
+    termination.max_evaluations = static_cast<uint64_t>(max_evaluations);
+    termination.max_seconds = max_time;
+    termination.target = target.is_none() ? std::numeric_limits<double>::quiet_NaN() : target.cast<double>();
+    termination.patience = patience;
+    termination.tolerance = tolerance;
+    termination.min_diversity = min_diversity;
+    bool active = max_evaluations > 0 || max_time > 0 || !target.is_none() || patience > 0 || min_diversity > 0; // Whether any test is on
+    return active ? &termination : nullptr;
+}
@@ -0,0 +1,84 @@
+# Local tests of the worker processes (n_workers) - runs with pytest, or on its own as python tests/test_workers.py
+# Each test forks a couple of workers on this machine, and checks the results, errors and clean-up of the process pool
+
+import os
+import random
+import signal
+
+import pytest
+
+from quickopt.genetic import genetic_int
+from quickopt.pso import pso
+
+
+def setup_function(_):
+    signal.alarm(120)  # Fail rather than hang if a worker is never reaped
+
+
+def teardown_function(_):
+    signal.alarm(0)
+    assert_no_children()
+
+
+def assert_no_children():
+    # Every worker must have been reaped by the time the call returns - a zombie or a live child is a leak
+    try:
+        pid, _ = os.waitpid(-1, os.WNOHANG)
+    except ChildProcessError:  # No children at all
+        return
+    raise AssertionError("worker process %d was left behind" % pid if pid else "a worker process is still running")
+
+
+def quadratic(x):
+    return -sum((v - 0.3) ** 2 for v in list(x))
+
+
+def test_pso_workers_match_serial():
+    # Workers move the swarm synchronously, as batch mode does, so with the same seed they must visit the same positions
+    args = dict(space_min=[-1.0] * 4, space_max=[1.0] * 4, iterations=20, swarm_size=16, verbose=-1, full_output=True, rng_seed=5)
+    serial, serial_info = pso(lambda xs: [quadratic(x) for x in xs], batch=True, **args)
+    pooled, pooled_info = pso(quadratic, n_workers=2, **args)
+    assert list(pooled) == list(serial)
+    assert pooled_info["stats"]["evaluations"] == serial_info["stats"]["evaluations"]
+
+
+def test_genetic_workers_match_serial():
+    def run(n_workers):
+        rng = random.Random(3)  # Same initial population for both runs
+        return genetic_int(lambda x: float(sum(list(x))), "bit_flip", lambda: [rng.randint(0, 1) for _ in range(24)],
+                           population_size=30, reproduction_ct=6, survivor_ct=3, generations=15, verbose=0,
+                           n_workers=n_workers, full_output=True, rng_seed=9)
+
+    serial, serial_info = run(0)
+    pooled, pooled_info = run(2)
+    assert list(pooled) == list(serial)
+    assert pooled_info["evaluations"] == serial_info["evaluations"]
+
+
+def test_worker_exception_is_raised():
+    def failing(x):
+        raise ValueError("objective failed on purpose")
+
+    with pytest.raises(RuntimeError, match="objective failed on purpose"):
+        pso(failing, [-1.0, -1.0], [1.0, 1.0], iterations=3, swarm_size=8, verbose=-1, n_workers=2)
+
+
+def test_killed_worker_is_reported():
+    parent = os.getpid()
+
+    def dying(x):
+        if os.getpid() != parent:  # In a worker...
+            os.kill(os.getpid(), signal.SIGKILL)  # Die mid-round
+        return quadratic(x)
+
+    with pytest.raises(RuntimeError, match="exited unexpectedly"):
+        pso(dying, [-1.0, -1.0], [1.0, 1.0], iterations=3, swarm_size=8, verbose=-1, n_workers=2)
+
+
+if __name__ == "__main__":
+    for name, test in list(globals().items()):
+        if name.startswith("test_"):
+            setup_function(test)
+            test()
+            teardown_function(test)
+            print(name, "passed")